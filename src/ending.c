@@ -10,7 +10,7 @@
 #include "engine/music.h"
 #include "engine/sprite.h"
 
-#include "game/status.h"
+#include "game/hud.h"
 
 #include "vpad.h"
 #include "global.h"
@@ -145,7 +145,7 @@ static void ending_reset()
     wave = 0.0f;
     plPos = 152.0f;
 
-    isVictory = status_get_star_count(2) == 25;
+    isVictory = hud_get_star_count(2) == 25;
 }
 
 
@@ -11,6 +11,8 @@
 #include "assets.h"
 #include "music.h"
 #include "sample.h"
+#include "mixer.h"
+#include "audio.h"
 
 #include "stdlib.h"
 #include "math.h"
@@ -35,6 +37,21 @@ static int newTicks;
 // (Timer) delta time
 static int deltaTime;
 
+// Is fast-forwarding
+static bool turbo;
+// Fast-forward updates per frame
+static int turboSteps = 8;
+// Draw every Kth frame when fast-forwarding
+static int turboDrawEvery = 1;
+// Frames since the last drawn one
+static int skippedFrames;
+// Updates in the current second
+static int updateCount;
+// Updates in the last second
+static int updateRate;
+// Start of the current second
+static Uint32 rateTicks;
+
 // Canvas pos
 static SDL_Point canvasPos;
 // Canvas size
@@ -150,6 +167,50 @@ bool app_is_full_screen()
 }
 
 
+// Set turbo
+void app_set_turbo(bool enabled, int steps, int drawEvery)
+{
+    turbo = enabled;
+    turboSteps = steps < 0 ? 1 : steps;
+    turboDrawEvery = drawEvery < 1 ? 1 : drawEvery;
+    skippedFrames = 0;
+
+    enable_samples(!turbo);
+    if(window != NULL && !turbo)
+        SDL_SetWindowTitle(window,config.title);
+}
+
+
+// Get update rate
+int app_get_update_rate()
+{
+    return updateRate;
+}
+
+
+// Count an update & show the rate in the title
+// when fast-forwarding
+static void app_count_update()
+{
+    char title[TITLE_STRING_SIZE + 32];
+    Uint32 now = SDL_GetTicks();
+
+    ++ updateCount;
+    if(now - rateTicks < 1000)
+        return;
+
+    updateRate = (int)(updateCount * 1000 / (now - rateTicks));
+    updateCount = 0;
+    rateTicks = now;
+
+    if(turbo)
+    {
+        snprintf(title,TITLE_STRING_SIZE + 32,"%s (%d ticks/s)",config.title,updateRate);
+        SDL_SetWindowTitle(window,title);
+    }
+}
+
+
 // Initialize application
 static int app_init(SCENE* arrScenes, int count, const char* assPath)
 {
@@ -182,7 +243,7 @@ static int app_init(SCENE* arrScenes, int count, const char* assPath)
 
     // Initialize audio
     init_samples();
-    if(init_music() == 1)
+    if(init_music(&config) == 1)
     {
         return 1;
     }
@@ -343,6 +404,12 @@ static void app_update(Uint32 delta)
         app_toggle_fullscreen();
     }
 
+    // Fast-forward
+    if(get_key_state(SDL_SCANCODE_F6) == PRESSED)
+    {
+        app_set_turbo(!turbo,turboSteps,turboDrawEvery);
+    }
+
     // Update current & global scenes
     if(currentScene.on_update != NULL)
     {
@@ -355,6 +422,11 @@ static void app_update(Uint32 delta)
 
     // Update controls
     ctr_update();
+    // End the sample frame
+    update_samples();
+    audio_step(config.fps);
+
+    app_count_update();
 }
 
 
@@ -404,7 +476,9 @@ static void app_destroy()
 
     SDL_JoystickClose(joy);
 
-    
+    mixer_destroy();
+    destroy_sample_arena();
+    audio_close();
 }
 
 
@@ -450,16 +524,34 @@ int app_run(SCENE* arrScenes, int count, CONFIG c)
     int frame_wait = (int)round(1000.0f / config.fps);
 
     if(app_init(arrScenes,count,NULL) != 0) return 1;
+    app_set_turbo(turbo,turboSteps,turboDrawEvery);
+    rateTicks = SDL_GetTicks();
 
+    int i;
     while(isRunning)
     {
         // Set old time
         oldTicks = SDL_GetTicks();
 
-        // Update frame
+        // Update frame, many times when fast-forwarding. Each
+        // update advances the time of one frame
         app_events();
         app_update(deltaTime);
-        app_draw();
+        for(i = 1; turbo && isRunning; ++ i)
+        {
+            if(turboSteps == APP_TURBO_UNBOUNDED ?
+                (int)(SDL_GetTicks() - oldTicks) >= frame_wait-1 : i >= turboSteps)
+                break;
+
+            app_update(deltaTime);
+        }
+
+        // Draw only every Kth frame when fast-forwarding
+        if(!turbo || ++ skippedFrames >= turboDrawEvery)
+        {
+            skippedFrames = 0;
+            app_draw();
+        }
 
         // Set new time
         newTicks = SDL_GetTicks();
@@ -10,6 +10,9 @@
 
 #include "stdbool.h"
 
+/// Fast-forward as many updates as fit in a frame
+#define APP_TURBO_UNBOUNDED 0
+
 /// Toggle fullscreen mode
 void app_toggle_fullscreen();
 
@@ -17,6 +20,18 @@ void app_toggle_fullscreen();
 /// > True or false
 bool app_is_full_screen();
 
+/// Set the fast-forward mode, toggled with F6. The sample
+/// effects are muted while fast-forwarding
+/// < enabled Is fast-forwarding
+/// < steps Updates per shown frame, or APP_TURBO_UNBOUNDED
+/// < drawEvery Draw only every Kth shown frame
+void app_set_turbo(bool enabled, int steps, int drawEvery);
+
+/// Get the updates run per second, measured over the
+/// last second
+/// > Update rate
+int app_get_update_rate();
+
 /// Swap scene
 /// < name The name of the new scene
 void app_swap_scene(const char* name);
@@ -11,6 +11,7 @@
 #include "../lib/tmxc.h"
 
 #include "bitmap.h"
+#include "mapcache.h"
 #include "music.h"
 #include "sample.h"
 
@@ -106,6 +107,9 @@ ASSET_PACK* load_asset_pack(const char* path)
     WORDDATA* w = parse_file(path);
     if(w == NULL)
     {
+        char err[256];
+        snprintf(err,256,"Failed to open an asset list in %s!",path);
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
         free(p);
         return NULL;
     }
@@ -120,7 +124,8 @@ ASSET_PACK* load_asset_pack(const char* path)
     p->names = (NAME*)malloc(sizeof(NAME) * p->assetCount);
     p->objects = (ANY*)malloc(sizeof(ANY) * p->assetCount);
     p->types = (int*)malloc(sizeof(int) * p->assetCount);
-    if(p->names == NULL || p->objects == NULL || p->types == NULL)
+    p->paths = (PATH*)malloc(sizeof(PATH) * p->assetCount);
+    if(p->names == NULL || p->objects == NULL || p->types == NULL || p->paths == NULL)
     {
         free(p);
         SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
@@ -171,7 +176,13 @@ ASSET_PACK* load_asset_pack(const char* path)
                 }
                 else if(assetType == T_TILEMAP)
                 {
-                    p->objects[index] = (ANY)load_tilemap(path);
+                    p->objects[index] = (ANY)mapcache_load(path);
+                    if(p->objects[index] == NULL)
+                    {
+                        char err[1024 +64];
+                        snprintf(err,1024 +64,"Failed to load a tilemap in %s!",path);
+                        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
+                    }
                 }
                 else if(assetType == T_MUSIC)
                 {
@@ -184,11 +195,13 @@ ASSET_PACK* load_asset_pack(const char* path)
 
                 p->types[index] = assetType;
                 strcpy(p->names[index].data,op[0]);
+                snprintf(p->paths[index].data,PATH_BUFFER_SIZE,"%s",path);
                 if(p->objects[index] == NULL)
                 {
                     free(p->objects);
                     free(p->names);
                     free(p->types);
+                    free(p->paths);
                     free(p);
                     return NULL;
                 }
@@ -217,6 +230,50 @@ ANY get_asset(ASSET_PACK* p, const char* name)
 }
 
 
+// Reload an asset
+ANY reload_asset(ASSET_PACK* p, const char* path)
+{
+    int i = 0;
+    for(; i < p->assetCount; ++ i)
+    {
+        if(strcmp(path,p->paths[i].data) == 0)
+            break;
+    }
+    if(i == p->assetCount) return NULL;
+
+    // Load a new copy and swap the contents, the old
+    // content is destroyed with the new shell
+    ANY obj = p->objects[i];
+    if(p->types[i] == T_BITMAP)
+    {
+        BITMAP* bmp = load_bitmap(path);
+        if(bmp == NULL) return NULL;
+
+        BITMAP tmp = *(BITMAP*)obj;
+        *(BITMAP*)obj = *bmp;
+        ((BITMAP*)obj)->c = tmp.c;
+        *bmp = tmp;
+        destroy_bitmap(bmp);
+    }
+    else if(p->types[i] == T_TILEMAP)
+    {
+        TILEMAP* t = mapcache_load(path);
+        if(t == NULL) return NULL;
+
+        TILEMAP tmp = *(TILEMAP*)obj;
+        *(TILEMAP*)obj = *t;
+        *t = tmp;
+        destroy_tilemap(t);
+    }
+    else
+    {
+        return NULL;
+    }
+
+    return obj;
+}
+
+
 // Destroy
 void destroy_asset_pack(ASSET_PACK* p)
 {
@@ -246,4 +303,10 @@ void destroy_asset_pack(ASSET_PACK* p)
             break;
         }
     }
-}
\ No newline at end of file
+
+    free(p->objects);
+    free(p->names);
+    free(p->types);
+    free(p->paths);
+    free(p);
+}
@@ -19,12 +19,23 @@ typedef struct
 }
 NAME;
 
+/// Asset path buffer size
+#define PATH_BUFFER_SIZE 256
+
+/// Path structure
+typedef struct
+{
+    char data[PATH_BUFFER_SIZE];
+}
+PATH;
+
 /// Asset pack type
 typedef struct
 {
     int* types;
     ANY* objects;
     NAME* names;
+    PATH* paths;
     Uint32 assetCount;
 }
 ASSET_PACK;
@@ -39,6 +50,14 @@ ASSET_PACK* load_asset_pack(const char* path);
 /// < name Asset name
 ANY get_asset(ASSET_PACK* p, const char* name);
 
+/// Reload an asset from its file, in place. Bitmaps and
+/// tilemaps keep their addresses, so pointers stored
+/// elsewhere stay valid
+/// < p Asset pack
+/// < path Asset file path
+/// > The reloaded asset, NULL if not found or failed
+ANY reload_asset(ASSET_PACK* p, const char* path);
+
 /// Destroy an asset pack
 /// < p Asset pack
 void destroy_asset_pack(ASSET_PACK* p);
@@ -0,0 +1,193 @@
+/// Audio output backends (source)
+/// (c) 2018 Jani Nykänen
+
+#include "audio.h"
+
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_mixer.h"
+
+#include "mixer.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+// Active backend
+static int backend = AUDIO_BACKEND_NULL;
+// Output rate
+static int outRate;
+
+// WAV output
+static FILE* wavFile = NULL;
+// Frames written
+static Uint64 wavFrames;
+// Simulation frames stepped
+static Uint64 steps;
+// Mix buffer
+static Sint16* wavBuffer = NULL;
+static int wavBufferFrames;
+
+
+// Write a little-endian integer
+static void write_le(FILE* f, Uint32 v, int bytes)
+{
+    Uint8 b[4];
+    int i = 0;
+    for(; i < bytes; ++ i)
+    {
+        b[i] = (Uint8)(v >> (i*8));
+    }
+    fwrite(b,1,bytes,f);
+}
+
+
+// Write the WAV header, sizes are filled on close
+static void write_wav_header(FILE* f, int rate, int channels, Uint32 dataBytes)
+{
+    fwrite("RIFF",1,4,f);
+    write_le(f,36 + dataBytes,4);
+    fwrite("WAVEfmt ",1,8,f);
+    write_le(f,16,4);
+    write_le(f,1,2);
+    write_le(f,channels,2);
+    write_le(f,rate,4);
+    write_le(f,rate * channels * 2,4);
+    write_le(f,channels * 2,2);
+    write_le(f,16,2);
+    fwrite("data",1,4,f);
+    write_le(f,dataBytes,4);
+}
+
+
+// Open SDL_mixer on the dummy driver
+static int open_dummy(int rate, int buffer)
+{
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    SDL_setenv("SDL_AUDIODRIVER","dummy",1);
+    if(Mix_OpenAudio(rate, MIX_DEFAULT_FORMAT, 2, buffer) == -1)
+    {
+        return 1;
+    }
+
+    // The mixer is not hooked to the device, so its thread
+    // only plays silence
+    return 0;
+}
+
+
+// Backend from name
+int audio_backend_from_name(const char* name)
+{
+    if(strcmp(name,"sdl") == 0)
+        return AUDIO_BACKEND_SDL;
+    else if(strcmp(name,"null") == 0)
+        return AUDIO_BACKEND_NULL;
+    else if(strcmp(name,"wav") == 0)
+        return AUDIO_BACKEND_WAV;
+
+    return -1;
+}
+
+
+// Open audio output
+int audio_open(int b, int rate, int buffer, const char* wavPath)
+{
+    backend = b;
+    steps = 0;
+    wavFrames = 0;
+
+    if(backend == AUDIO_BACKEND_SDL)
+    {
+        if(Mix_OpenAudio(rate, MIX_DEFAULT_FORMAT, 2, buffer) == 0)
+        {
+            outRate = rate;
+            return 0;
+        }
+
+        printf("Failed to open audio (%s), no sound output.\n",SDL_GetError());
+        backend = AUDIO_BACKEND_NULL;
+    }
+
+    if(open_dummy(rate,buffer) != 0)
+    {
+        printf("Failed to open audio: %s\n",SDL_GetError());
+        return 1;
+    }
+
+    int channels;
+    Uint16 format;
+    Mix_QuerySpec(&outRate,&format,&channels);
+
+    if(backend == AUDIO_BACKEND_WAV)
+    {
+        wavFile = fopen(wavPath,"wb");
+        wavBufferFrames = outRate / 10 + 1;
+        wavBuffer = (Sint16*)malloc(sizeof(Sint16) * wavBufferFrames * channels);
+        if(wavFile == NULL || wavBuffer == NULL)
+        {
+            printf("Failed to open a WAV output in %s!\n",wavPath);
+            if(wavFile != NULL) fclose(wavFile);
+            free(wavBuffer);
+            wavFile = NULL;
+            wavBuffer = NULL;
+            backend = AUDIO_BACKEND_NULL;
+            return 0;
+        }
+        write_wav_header(wavFile,outRate,channels,0);
+    }
+
+    return 0;
+}
+
+
+// Step one simulation frame
+void audio_step(int fps)
+{
+    if(backend == AUDIO_BACKEND_SDL || fps <= 0) return;
+
+    // Integer frame counts that sum up to the exact rate
+    Uint64 end = (steps + 1) * (Uint64)outRate / (Uint64)fps;
+    int frames = (int)(end - steps * (Uint64)outRate / (Uint64)fps);
+    int channels = mixer_get_channels();
+    int n;
+    ++ steps;
+
+    // Keep the voices moving, but do not mix
+    if(backend == AUDIO_BACKEND_NULL)
+    {
+        mixer_advance(frames);
+        return;
+    }
+
+    while(frames > 0)
+    {
+        n = frames > wavBufferFrames ? wavBufferFrames : frames;
+        mixer_render(wavBuffer,n);
+        fwrite(wavBuffer,sizeof(Sint16),n * channels,wavFile);
+        wavFrames += n;
+        frames -= n;
+    }
+}
+
+
+// Get backend
+int audio_get_backend()
+{
+    return backend;
+}
+
+
+// Close
+void audio_close()
+{
+    if(wavFile != NULL)
+    {
+        fseek(wavFile,0,SEEK_SET);
+        write_wav_header(wavFile,outRate,mixer_get_channels(),
+            (Uint32)(wavFrames * mixer_get_channels() * sizeof(Sint16)));
+        fclose(wavFile);
+        wavFile = NULL;
+    }
+    free(wavBuffer);
+    wavBuffer = NULL;
+}
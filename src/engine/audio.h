@@ -0,0 +1,47 @@
+/// Audio output backends (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __AUDIO__
+#define __AUDIO__
+
+#include "stdbool.h"
+
+/// Audio backends
+enum
+{
+    AUDIO_BACKEND_SDL = 0, /// Sound device
+    AUDIO_BACKEND_NULL = 1, /// No output
+    AUDIO_BACKEND_WAV = 2, /// Written to a WAV file, one frame at a time
+};
+
+/// Get a backend by its name ("sdl", "null" or "wav")
+/// < name Backend name
+/// > Backend, -1 if unknown
+int audio_backend_from_name(const char* name);
+
+/// Open audio output. The null & WAV backends run
+/// SDL_mixer on the dummy driver, so they need no sound
+/// hardware, and the mixer must not be hooked to it. If
+/// the sound device cannot be opened, the null backend
+/// is used instead
+/// < backend Backend
+/// < rate Sample rate
+/// < buffer Buffer size in frames
+/// < wavPath Output file of the WAV backend
+/// > 0 on success, 1 on error
+int audio_open(int backend, int rate, int buffer, const char* wavPath);
+
+/// Advance the audio by one simulation frame. The WAV
+/// backend mixes and writes exactly rate/fps frames, the
+/// null backend only advances the voices
+/// < fps Simulation frame rate
+void audio_step(int fps);
+
+/// Get the active backend
+/// > Backend
+int audio_get_backend();
+
+/// Close audio output & finish the WAV file
+void audio_close();
+
+#endif // __AUDIO__
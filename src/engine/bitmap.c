@@ -10,6 +10,98 @@
 #include "stdlib.h"
 #include "math.h"
 #include "stdio.h"
+#include "string.h"
+#include "stdbool.h"
+
+/// Color lookup table size (power of two, larger than
+/// the maximum palette size)
+#define LOOKUP_SIZE 512
+
+
+// Pack a color to a 32-bit value
+static Uint32 pack_color(const Uint8* p)
+{
+    return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+
+
+// Try to convert RGBA data to indexed data. Fails if
+// the image has more than BITMAP_MAX_COLORS colors
+static bool make_indexed(BITMAP* bmp, const Uint8* pdata)
+{
+    Uint32 keys[LOOKUP_SIZE];
+    short values[LOOKUP_SIZE];
+    memset(values,-1,sizeof(values));
+
+    int count = bmp->w * bmp->h;
+    Uint8* indices = (Uint8*)malloc(count > 0 ? count : 1);
+    COLOR* palette = (COLOR*)malloc(sizeof(COLOR) * BITMAP_MAX_COLORS);
+    if(indices == NULL || palette == NULL)
+    {
+        free(indices);
+        free(palette);
+        return false;
+    }
+
+    int size = 0;
+    int i = 0;
+    Uint32 col;
+    Uint32 slot;
+    const Uint8* p;
+    for(; i < count; ++ i)
+    {
+        p = pdata + i*4;
+        col = pack_color(p);
+
+        // Find the color, add it if not found
+        slot = (col * 2654435761u) >> 23;
+        while(values[slot] >= 0 && keys[slot] != col)
+        {
+            slot = (slot + 1) & (LOOKUP_SIZE-1);
+        }
+        if(values[slot] < 0)
+        {
+            if(size == BITMAP_MAX_COLORS)
+            {
+                free(indices);
+                free(palette);
+                return false;
+            }
+
+            keys[slot] = col;
+            values[slot] = (short)size;
+            palette[size ++] = (COLOR){p[0],p[1],p[2],p[3]};
+        }
+        indices[i] = (Uint8)values[slot];
+    }
+
+    bmp->indices = indices;
+    bmp->palette = palette;
+    bmp->paletteSize = size;
+
+    return true;
+}
+
+
+// Expand indexed data and upload it to the texture
+static int upload_indexed(BITMAP* bmp)
+{
+    int count = bmp->w * bmp->h;
+    COLOR* pixels = (COLOR*)malloc(sizeof(COLOR) * (count > 0 ? count : 1));
+    if(pixels == NULL)
+        return 1;
+
+    int i = 0;
+    for(; i < count; ++ i)
+    {
+        pixels[i] = bmp->palette[bmp->indices[i]];
+    }
+
+    int ret = SDL_UpdateTexture(bmp->tex,NULL,pixels,bmp->w*4);
+    free(pixels);
+
+    return ret == 0 ? 0 : 1;
+}
 
 
 // Load bitmap
@@ -22,6 +114,9 @@ BITMAP* load_bitmap(const char* path)
         SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to allocate memory for a bitmap!\n",NULL);
         return NULL;
     }
+    bmp->indices = NULL;
+    bmp->palette = NULL;
+    bmp->paletteSize = 0;
 
     int comp;
     // Load image
@@ -34,33 +129,70 @@ BITMAP* load_bitmap(const char* path)
         return NULL;
     }
 
-    // Create surface
-    SDL_Surface* surf = SDL_CreateRGBSurfaceFrom((void*)pdata, bmp->w, bmp->h, 32, bmp->w*4,
-                                             0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
-    if(surf == NULL)
+    // Keep pixel art with a small palette as indexed data, it is
+    // expanded to RGBA only when uploaded to the texture
+    if(make_indexed(bmp,pdata))
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to create a surface!",NULL);
-        return NULL;
-    }
+        stbi_image_free(pdata);
+        pdata = NULL;
 
-    // Create texture
-    bmp->tex = SDL_CreateTextureFromSurface(get_global_renderer(),surf);
-    if(bmp->tex == NULL)
+        bmp->tex = SDL_CreateTexture(get_global_renderer(),SDL_PIXELFORMAT_RGBA32,
+            SDL_TEXTUREACCESS_STATIC,bmp->w,bmp->h);
+        if(bmp->tex == NULL || upload_indexed(bmp) != 0)
+        {
+            SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to create a texture from indexed data!",NULL);
+            return NULL;
+        }
+        SDL_SetTextureBlendMode(bmp->tex,SDL_BLENDMODE_BLEND);
+
+        int rgbaSize = bmp->w*bmp->h*4;
+        int indexedSize = bmp->w*bmp->h + bmp->paletteSize*(int)sizeof(COLOR);
+        printf("%s: %d colors, %d bytes indexed, %d bytes saved\n",
+            path,bmp->paletteSize,indexedSize,rgbaSize-indexedSize);
+    }
+    else
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to create a texture from a surface!",NULL);
-        return NULL;
+        // Create surface
+        SDL_Surface* surf = SDL_CreateRGBSurfaceFrom((void*)pdata, bmp->w, bmp->h, 32, bmp->w*4,
+                                                 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+        if(surf == NULL)
+        {
+            SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to create a surface!",NULL);
+            return NULL;
+        }
+
+        // Create texture
+        bmp->tex = SDL_CreateTextureFromSurface(get_global_renderer(),surf);
+        if(bmp->tex == NULL)
+        {
+            SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to create a texture from a surface!",NULL);
+            return NULL;
+        }
+
+        // Free surface
+        SDL_FreeSurface(surf);
+
+        // Free data
+        stbi_image_free(pdata);
     }
 
     // Set color to white
     bmp->c = rgb(255,255,255);
 
-    // Free surface
-    SDL_FreeSurface(surf);
+    return bmp;
+}
+
 
-    // Free data
-    stbi_image_free(pdata);
+// Replace the palette
+int bitmap_set_palette(BITMAP* bmp, const COLOR* pal, int count)
+{
+    if(bmp->indices == NULL) return 1;
 
-    return bmp;
+    if(count > bmp->paletteSize)
+        count = bmp->paletteSize;
+    memcpy(bmp->palette,pal,sizeof(COLOR) * count);
+
+    return upload_indexed(bmp);
 }
 
 
@@ -70,5 +202,7 @@ void destroy_bitmap(BITMAP* bmp)
     if(bmp == NULL) return;
 
     SDL_DestroyTexture(bmp->tex);
+    free(bmp->indices);
+    free(bmp->palette);
     free(bmp);
 }
@@ -15,6 +15,9 @@ COLOR;
 #define rgb(r,g,b) (COLOR){r,g,b,255}
 #define rgba(r,g,b,a) (COLOR){rg,b,a}
 
+/// Maximum palette size of an indexed bitmap
+#define BITMAP_MAX_COLORS 256
+
 /// Bitmap type
 typedef struct
 {
@@ -22,6 +25,10 @@ typedef struct
     int h; /// Bitmap height
     SDL_Texture* tex; /// Texture
     COLOR c; /// Color (needed in one place only)
+
+    Uint8* indices; /// Indexed pixel data, NULL for true color bitmaps
+    COLOR* palette; /// Palette
+    int paletteSize; /// Palette size
 }
 BITMAP;
 
@@ -30,6 +37,14 @@ BITMAP;
 /// > Returns a new bitmap (pointer)
 BITMAP* load_bitmap(const char* path);
 
+/// Replace the palette of an indexed bitmap. The texture
+/// is updated from the indexed data, no decoding needed
+/// < bmp Bitmap
+/// < pal New palette
+/// < count Color count, at most the palette size
+/// > 0 on success, 1 on error
+int bitmap_set_palette(BITMAP* bmp, const COLOR* pal, int count);
+
 /// Destroy bitmap
 void destroy_bitmap(BITMAP* bmp);
 
@@ -12,6 +12,7 @@
 
 #include "../lib/parseword.h"
 #include "error.h"
+#include "audio.h"
 
 #include "stdlib.h"
 #include "stdio.h"
@@ -36,6 +37,13 @@ int read_config(CONFIG* c, const char* path)
         return 1;
     }
 
+    // Default values for optional keys
+    c->voices = DEFAULT_AUDIO_VOICES;
+    c->audioRate = DEFAULT_AUDIO_RATE;
+    c->audioBuffer = DEFAULT_AUDIO_BUFFER;
+    c->audioBackend = AUDIO_BACKEND_SDL;
+    snprintf(c->audioWav,ASSET_PATH_SIZE,"audio.wav");
+
     // Read words
     int count = 0;
     int i = 0;
@@ -75,6 +83,28 @@ int read_config(CONFIG* c, const char* path)
             {
                 c->fullscreen = (bool)strtol(value,NULL,10);
             }
+            else if(strcmp(key,"audio_voices") == 0)
+            {
+                c->voices = (int)strtol(value,NULL,10);
+            }
+            else if(strcmp(key,"audio_rate") == 0)
+            {
+                c->audioRate = (int)strtol(value,NULL,10);
+            }
+            else if(strcmp(key,"audio_buffer") == 0)
+            {
+                c->audioBuffer = (int)strtol(value,NULL,10);
+            }
+            else if(strcmp(key,"audio_backend") == 0)
+            {
+                c->audioBackend = audio_backend_from_name(value);
+                if(c->audioBackend < 0)
+                    c->audioBackend = AUDIO_BACKEND_SDL;
+            }
+            else if(strcmp(key,"audio_wav") == 0)
+            {
+                snprintf(c->audioWav,ASSET_PATH_SIZE,"%s",value);
+            }
         }
 
         count = !count;
@@ -10,6 +10,12 @@
 #define TITLE_STRING_SIZE 64
 /// Asset path size
 #define ASSET_PATH_SIZE 256
+/// Default mixer voice count
+#define DEFAULT_AUDIO_VOICES 16
+/// Default audio sample rate
+#define DEFAULT_AUDIO_RATE 44100
+/// Default audio buffer size in frames
+#define DEFAULT_AUDIO_BUFFER 512
 
 /// Configuration structure 
 typedef struct
@@ -21,6 +27,11 @@ typedef struct
     int fps;
     bool fullscreen;
     char title[TITLE_STRING_SIZE];
+    int voices;
+    int audioRate;
+    int audioBuffer;
+    int audioBackend;
+    char audioWav[ASSET_PATH_SIZE];
 }
 CONFIG;
 
@@ -209,4 +209,18 @@ void translate(int x, int y)
 {
     transX = x;
     transY = y;
-}
\ No newline at end of file
+}
+
+
+// Draw a sprite frame
+void spr_draw_frame(SPRITE*s, BITMAP* bmp, int frame, int row, int x, int y, int flip)
+{
+    draw_bitmap_region(bmp,s->w*frame,s->h*row,s->w,s->h,x,y,flip);
+}
+
+
+// Draw a sprite
+void spr_draw(SPRITE* s, BITMAP* bmp, int x, int y, int flip)
+{
+    spr_draw_frame(s,bmp,s->frame,s->row,x,y,flip);
+}
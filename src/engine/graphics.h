@@ -7,6 +7,7 @@
 #include "stdbool.h"
 
 #include "bitmap.h"
+#include "sprite.h"
 #include "vector.h"
 
 /// Flipping enumerations
@@ -110,4 +111,22 @@ void set_bitmap_color(BITMAP* b, COLOR c);
 /// < y Vertical translation
 void translate(int x, int y);
 
+/// Draw a sprite frame
+/// < s Sprite to draw
+/// < bmp Bitmap to use
+/// < frame Sprite frame to draw
+/// < row Sprite row to draw
+/// < x Destination X 
+/// < y Destination Y
+/// < flip Flipping flag
+void spr_draw_frame(SPRITE*s, BITMAP* bmp, int frame, int row, int x, int y, int flip);
+
+/// Draw a sprite
+/// < s Sprite to draw
+/// < bmp Bitmap to use
+/// < x Destination X 
+/// < y Destination Y
+/// < flip Flipping flag
+void spr_draw(SPRITE* s, BITMAP* bmp, int x, int y, int flip);
+
 #endif // __GRAPHICS__
@@ -0,0 +1,164 @@
+/// Asset hot reload (source)
+/// (c) 2018 Jani Nykänen
+
+#include "hotreload.h"
+
+#include "stdio.h"
+#include "string.h"
+
+#ifdef __linux__
+#include "sys/inotify.h"
+#include "unistd.h"
+#include "errno.h"
+#endif
+
+/// Maximum amount of watched directories
+#define MAX_WATCH 8
+/// Maximum amount of reloads per poll
+#define MAX_CHANGED 32
+
+// Asset pack
+static ASSET_PACK* pack = NULL;
+// Callback
+static RELOAD_CB onReload = NULL;
+
+#ifdef __linux__
+
+// inotify descriptor
+static int fd = -1;
+// Watched directories
+static int watches[MAX_WATCH];
+static PATH dirs[MAX_WATCH];
+static int watchCount = 0;
+
+
+// Initialize
+int hotreload_init(ASSET_PACK* p, RELOAD_CB cb)
+{
+    pack = p;
+    onReload = cb;
+    watchCount = 0;
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0)
+    {
+        printf("Failed to initialize the file watcher!\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+// Watch a directory
+int hotreload_watch(const char* dir)
+{
+    if(fd < 0 || watchCount >= MAX_WATCH) return 1;
+
+    // Editors either rewrite the file or move a temporary
+    // file over it
+    int wd = inotify_add_watch(fd,dir,IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(wd < 0)
+    {
+        printf("Failed to watch %s!\n",dir);
+        return 1;
+    }
+
+    watches[watchCount] = wd;
+    snprintf(dirs[watchCount].data,PATH_BUFFER_SIZE,"%s",dir);
+    ++ watchCount;
+
+    return 0;
+}
+
+
+// Reload changed assets
+void hotreload_poll()
+{
+    if(fd < 0) return;
+
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event* ev;
+    PATH changed[MAX_CHANGED];
+    int count = 0;
+    char path[PATH_BUFFER_SIZE];
+    ssize_t len;
+    char* p;
+    int i, j;
+
+    // Collect the changed files, one save may produce
+    // several events
+    for(;;)
+    {
+        len = read(fd,buf,sizeof(buf));
+        if(len <= 0) break;
+
+        for(p = buf; p < buf + len; p += sizeof(struct inotify_event) + ev->len)
+        {
+            ev = (const struct inotify_event*)p;
+            if(ev->len == 0) continue;
+
+            for(i = 0; i < watchCount && watches[i] != ev->wd; ++ i);
+            if(i == watchCount) continue;
+
+            snprintf(path,PATH_BUFFER_SIZE,"%s/%s",dirs[i].data,ev->name);
+            for(j = 0; j < count && strcmp(changed[j].data,path) != 0; ++ j);
+            if(j == count && count < MAX_CHANGED)
+            {
+                strcpy(changed[count ++].data,path);
+            }
+        }
+    }
+
+    // Reload only the changed assets
+    Uint64 start;
+    ANY obj;
+    for(i = 0; i < count; ++ i)
+    {
+        start = SDL_GetPerformanceCounter();
+        obj = reload_asset(pack,changed[i].data);
+        if(obj == NULL) continue;
+
+        if(onReload != NULL)
+            onReload(obj);
+
+        printf("Reloaded %s in %.2f ms\n",changed[i].data,
+            (double)(SDL_GetPerformanceCounter()-start) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+    }
+}
+
+
+// Stop watching
+void hotreload_destroy()
+{
+    if(fd >= 0)
+        close(fd);
+    fd = -1;
+    watchCount = 0;
+}
+
+#else
+
+// Initialize
+int hotreload_init(ASSET_PACK* p, RELOAD_CB cb)
+{
+    pack = p;
+    onReload = cb;
+    return 1;
+}
+
+
+// Watch a directory
+int hotreload_watch(const char* dir)
+{
+    return 1;
+}
+
+
+// Reload changed assets
+void hotreload_poll() { }
+
+
+// Stop watching
+void hotreload_destroy() { }
+
+#endif
@@ -0,0 +1,32 @@
+/// Asset hot reload (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __HOT_RELOAD__
+#define __HOT_RELOAD__
+
+#include "assets.h"
+
+#include "stdbool.h"
+
+/// Reload callback, called after an asset has been reloaded
+typedef void (*RELOAD_CB)(ANY obj);
+
+/// Initialize the file watcher. Only supported on Linux
+/// (inotify), elsewhere the functions do nothing
+/// < p Asset pack to reload assets in
+/// < cb Reload callback
+/// > 0 on success, 1 on error
+int hotreload_init(ASSET_PACK* p, RELOAD_CB cb);
+
+/// Watch a directory for changed files
+/// < dir Directory path, without a trailing slash
+/// > 0 on success, 1 on error
+int hotreload_watch(const char* dir);
+
+/// Reload the assets changed since the last call. Does not block
+void hotreload_poll();
+
+/// Stop watching
+void hotreload_destroy();
+
+#endif // __HOT_RELOAD__
@@ -0,0 +1,444 @@
+/// Compiled map cache (source)
+/// (c) 2018 Jani Nykänen
+
+#include "mapcache.h"
+
+#include "SDL2/SDL.h"
+
+#include "../lib/parseword.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#include "sys/stat.h"
+#include "sys/types.h"
+#ifdef _WIN32
+#include "direct.h"
+#endif
+
+/// Cache file magic ("AQMC")
+#define CACHE_MAGIC 0x434D5141
+/// Cache format version, bump when the layout changes
+#define CACHE_VERSION 2
+/// Path buffer size
+#define CACHE_PATH_SIZE 1024
+
+/// Cache file header. Followed by the layers (width*height
+/// bytes each) and the spawn points (id, x, y bytes each)
+typedef struct
+{
+    Uint32 magic;
+    Uint32 version;
+    /// Content hash of the source file & the spawn rules
+    Uint64 hash;
+    /// Source file size & modification time, used to
+    /// skip hashing when the source is untouched
+    Uint64 srcSize;
+    Uint64 srcTime;
+    /// Time the source was checked. The time stamps are in
+    /// whole seconds, so they can only be trusted if the
+    /// source is strictly older than the check
+    Uint64 checkTime;
+    Uint16 width;
+    Uint16 height;
+    Uint16 tileW;
+    Uint16 tileH;
+    Uint16 layerCount;
+    Uint16 spawnCount;
+}
+CACHE_HEADER;
+
+// Cache directory, NULL if the cache is not in use
+static const char* cacheDir = NULL;
+// Spawn filter
+static bool (*spawnFilter)(int) = NULL;
+// Hash of the spawn rules
+static Uint64 ruleHash;
+
+
+// FNV-1a, 64-bit
+static Uint64 hash_bytes(Uint64 h, const Uint8* data, size_t len)
+{
+    size_t i = 0;
+    for(; i < len; ++ i)
+    {
+        h ^= (Uint64)data[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+
+// Read a whole file at once
+static Uint8* read_file(const char* path, long* size)
+{
+    FILE* f = fopen(path,"rb");
+    if(f == NULL)
+        return NULL;
+
+    fseek(f,0,SEEK_END);
+    *size = ftell(f);
+    fseek(f,0,SEEK_SET);
+
+    Uint8* data = (Uint8*)malloc(*size > 0 ? *size : 1);
+    if(data == NULL || *size <= 0 || fread(data,1,*size,f) != (size_t)*size)
+    {
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    return data;
+}
+
+
+// Get the cache file path for a source file
+static void get_cache_path(const char* path, char* out)
+{
+    snprintf(out,CACHE_PATH_SIZE,"%s/%s.bin",cacheDir,path);
+
+    // Flatten the source path to a single file name
+    char* c = out + strlen(cacheDir) +1;
+    for(; *c != 0; ++ c)
+    {
+        if(*c == '/' || *c == '\\' || *c == ':')
+            *c = '_';
+    }
+}
+
+
+// Can the map be stored in the compact form
+static bool is_compilable(TILEMAP* t)
+{
+    // Object layers & properties are not part of the compact
+    // form, so such maps are always parsed from the source
+    if(t->objectCount > 0 || t->propertyCount > 0 || t->objectLayerCount > 0)
+        return false;
+
+    if(t->width <= 0 || t->height <= 0 || t->width > 256 || t->height > 256
+     || t->tileW > 0xFFFF || t->tileH > 0xFFFF || t->layerCount > 0xFFFF)
+        return false;
+
+    int i, j;
+    for(j = 0; j < t->layerCount; ++ j)
+    {
+        for(i = 0; i < t->tcount; ++ i)
+        {
+            if(t->layers[j][i] < 0 || t->layers[j][i] > 255)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Write a compiled map
+static void write_cache(const char* cpath, TILEMAP* t, Uint64 hash, struct stat* st, time_t checked)
+{
+    if(!is_compilable(t))
+        return;
+
+    size_t size = sizeof(CACHE_HEADER) + (size_t)t->tcount*t->layerCount + (size_t)t->spawnCount*3;
+    Uint8* data = (Uint8*)malloc(size);
+    if(data == NULL)
+        return;
+
+    CACHE_HEADER h;
+    memset(&h,0,sizeof(CACHE_HEADER));
+    h.magic = CACHE_MAGIC;
+    h.version = CACHE_VERSION;
+    h.hash = hash;
+    h.srcSize = (Uint64)st->st_size;
+    h.srcTime = (Uint64)st->st_mtime;
+    h.checkTime = (Uint64)checked;
+    h.width = (Uint16)t->width;
+    h.height = (Uint16)t->height;
+    h.tileW = (Uint16)t->tileW;
+    h.tileH = (Uint16)t->tileH;
+    h.layerCount = (Uint16)t->layerCount;
+    h.spawnCount = (Uint16)t->spawnCount;
+    memcpy(data,&h,sizeof(CACHE_HEADER));
+
+    Uint8* p = data + sizeof(CACHE_HEADER);
+    int i, j;
+    for(j = 0; j < t->layerCount; ++ j)
+    {
+        for(i = 0; i < t->tcount; ++ i)
+        {
+            *(p ++) = (Uint8)t->layers[j][i];
+        }
+    }
+    for(i = 0; i < t->spawnCount; ++ i)
+    {
+        *(p ++) = (Uint8)t->spawns[i].id;
+        *(p ++) = (Uint8)t->spawns[i].x;
+        *(p ++) = (Uint8)t->spawns[i].y;
+    }
+
+    FILE* f = fopen(cpath,"wb");
+    if(f == NULL)
+    {
+        printf("Failed to write a map cache entry in %s!\n",cpath);
+        free(data);
+        return;
+    }
+    if(fwrite(data,1,size,f) != size)
+    {
+        printf("Failed to write a map cache entry in %s!\n",cpath);
+    }
+    fclose(f);
+    free(data);
+}
+
+
+// Build a tilemap from a compiled map
+static TILEMAP* read_compiled(const Uint8* data, long size)
+{
+    const CACHE_HEADER* h = (const CACHE_HEADER*)data;
+    int tcount = (int)h->width * (int)h->height;
+    if((size_t)size != sizeof(CACHE_HEADER) + (size_t)tcount*h->layerCount + (size_t)h->spawnCount*3)
+        return NULL;
+
+    TILEMAP* t = (TILEMAP*)calloc(1,sizeof(TILEMAP));
+    if(t == NULL)
+        return NULL;
+
+    t->width = h->width;
+    t->height = h->height;
+    t->tileW = h->tileW;
+    t->tileH = h->tileH;
+    t->pwidth = t->width * t->tileW;
+    t->pheight = t->height * t->tileH;
+    t->tcount = tcount;
+
+    t->layers = (LAYER*)calloc(h->layerCount > 0 ? h->layerCount : 1,sizeof(LAYER));
+    t->spawns = (TMX_SPAWN*)malloc(sizeof(TMX_SPAWN) * (h->spawnCount > 0 ? h->spawnCount : 1));
+    if(t->layers == NULL || t->spawns == NULL)
+    {
+        destroy_tilemap(t);
+        return NULL;
+    }
+
+    const Uint8* p = data + sizeof(CACHE_HEADER);
+    int i, j;
+    for(j = 0; j < h->layerCount; ++ j)
+    {
+        t->layers[j] = (LAYER)malloc(sizeof(int) * (tcount > 0 ? tcount : 1));
+        if(t->layers[j] == NULL)
+        {
+            destroy_tilemap(t);
+            return NULL;
+        }
+        ++ t->layerCount;
+
+        for(i = 0; i < tcount; ++ i)
+        {
+            t->layers[j][i] = (int)*(p ++);
+        }
+    }
+    for(i = 0; i < h->spawnCount; ++ i, p += 3)
+    {
+        t->spawns[i] = (TMX_SPAWN){p[0],p[1],p[2]};
+    }
+    t->spawnCount = h->spawnCount;
+
+    return t;
+}
+
+
+// Load a tilemap through the cache
+// (status: 0 cache hit, 1 rebuilt, 2 not cacheable)
+static TILEMAP* load_cached(const char* path, int* status)
+{
+    char cpath[CACHE_PATH_SIZE];
+    get_cache_path(path,cpath);
+
+    // Taken before the stat, any later edit is newer
+    time_t checked = time(NULL);
+    struct stat st;
+    if(stat(path,&st) != 0)
+    {
+        printf("Failed to load a tilemap in %s!\n",path);
+        return NULL;
+    }
+
+    // Cached copy
+    long csize = 0;
+    Uint8* cdata = read_file(cpath,&csize);
+    const CACHE_HEADER* h = (const CACHE_HEADER*)cdata;
+    bool valid = cdata != NULL && (size_t)csize >= sizeof(CACHE_HEADER)
+        && h->magic == CACHE_MAGIC && h->version == CACHE_VERSION;
+
+    // Untouched source, no need to read it at all. An edit
+    // in the same second as the check keeps the time stamp,
+    // so then the source is hashed anyway
+    TILEMAP* t = NULL;
+    if(valid && h->srcSize == (Uint64)st.st_size && h->srcTime == (Uint64)st.st_mtime
+        && h->srcTime < h->checkTime)
+    {
+        t = read_compiled(cdata,csize);
+        if(t != NULL)
+        {
+            free(cdata);
+            *status = 0;
+            return t;
+        }
+    }
+
+    // Hash the source
+    long size = 0;
+    Uint8* data = read_file(path,&size);
+    if(data == NULL)
+    {
+        printf("Failed to load a tilemap in %s!\n",path);
+        free(cdata);
+        return NULL;
+    }
+    Uint64 hash = hash_bytes(ruleHash,data,size);
+
+    // Same content, only the time stamp changed
+    if(valid && h->hash == hash)
+    {
+        t = read_compiled(cdata,csize);
+        if(t != NULL)
+        {
+            free(data);
+            free(cdata);
+            write_cache(cpath,t,hash,&st,checked);
+            *status = 0;
+            return t;
+        }
+    }
+    free(cdata);
+
+    // Stale or missing, rebuild
+    t = parse_tilemap((const char*)data,(int)size);
+    free(data);
+    if(t == NULL || tmx_extract_spawns(t,0,spawnFilter) != 0)
+    {
+        if(t != NULL) destroy_tilemap(t);
+        return NULL;
+    }
+
+    *status = is_compilable(t) ? 1 : 2;
+    write_cache(cpath,t,hash,&st,checked);
+
+    return t;
+}
+
+
+// Initialize
+void mapcache_init(const char* dir, bool (*filter)(int))
+{
+    cacheDir = dir;
+    spawnFilter = filter;
+
+    // The spawn rules are a part of the key, so changing
+    // them invalidates the whole cache
+    Uint8 rules[256];
+    int i = 0;
+    for(; i < 256; ++ i)
+    {
+        rules[i] = (Uint8)filter(i);
+    }
+    Uint32 version = CACHE_VERSION;
+    ruleHash = hash_bytes(0xCBF29CE484222325ULL,(const Uint8*)&version,sizeof(Uint32));
+    ruleHash = hash_bytes(ruleHash,rules,256);
+
+    // Create the directory, fails silently if it exists
+#ifdef _WIN32
+    _mkdir(dir);
+#else
+    mkdir(dir,0755);
+#endif
+}
+
+
+// Load a tilemap
+TILEMAP* mapcache_load(const char* path)
+{
+    if(cacheDir == NULL)
+        return load_tilemap(path);
+
+    int status;
+    return load_cached(path,&status);
+}
+
+
+// Pre-warm the cache
+int mapcache_warm(const char* assetList)
+{
+    if(cacheDir == NULL)
+        return 1;
+
+    WORDDATA* w = parse_file(assetList);
+    if(w == NULL)
+        return 1;
+
+    const char* STATUS[] = {"up to date","compiled","not cacheable"};
+
+    char* filePath = "";
+    bool isTilemap = false;
+    bool begun = false;
+    int index = 0;
+    int err = 0;
+    int count = 0;
+    char* word;
+    char path[CACHE_PATH_SIZE];
+    int status;
+    TILEMAP* t;
+
+    int i = 0;
+    for(; i < w->wordCount; ++ i)
+    {
+        word = get_word(w,i);
+        if(!begun)
+        {
+            if(strcmp(word,"@path") == 0 && i+1 < w->wordCount)
+            {
+                filePath = get_word(w,++ i);
+            }
+            else if(strcmp(word,"@type") == 0 && i+1 < w->wordCount)
+            {
+                isTilemap = strcmp(get_word(w,++ i),"tilemap") == 0;
+            }
+            else if(strcmp(word,"{") == 0)
+            {
+                begun = true;
+                index = 0;
+            }
+            continue;
+        }
+
+        if(strcmp(word,"}") == 0)
+        {
+            begun = false;
+            continue;
+        }
+
+        // Every second word in a block is a file name
+        index = !index;
+        if(index == 1 || !isTilemap)
+            continue;
+
+        snprintf(path,CACHE_PATH_SIZE,"%s%s",filePath,word);
+        t = load_cached(path,&status);
+        if(t == NULL)
+        {
+            printf("%s: failed\n",path);
+            err = 1;
+            continue;
+        }
+        printf("%s: %s\n",path,STATUS[status]);
+        destroy_tilemap(t);
+        ++ count;
+    }
+    destroy_word_data(w);
+
+    printf("%d tilemaps in %s/\n",count,cacheDir);
+    return err;
+}
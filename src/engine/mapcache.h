@@ -0,0 +1,29 @@
+/// Compiled map cache (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __MAP_CACHE__
+#define __MAP_CACHE__
+
+#include "../lib/tmxc.h"
+
+#include "stdbool.h"
+
+/// Initialize the map cache. Before this is called,
+/// tilemaps are parsed from the source files directly
+/// < dir Cache directory
+/// < spawnFilter Returns true for the tile IDs that create an object
+void mapcache_init(const char* dir, bool (*spawnFilter)(int));
+
+/// Load a tilemap through the cache. If the cached copy is
+/// missing or stale, the source file is parsed and the cache
+/// entry is rebuilt
+/// < path Tilemap path
+/// > A new tilemap, NULL on error
+TILEMAP* mapcache_load(const char* path);
+
+/// Compile all the tilemaps in an asset list to the cache
+/// < assetList Asset list path
+/// > 0 on success, 1 on error
+int mapcache_warm(const char* assetList);
+
+#endif // __MAP_CACHE__
@@ -0,0 +1,637 @@
+/// Software audio mixer (source)
+/// (c) 2018 Jani Nykänen
+
+#include "mixer.h"
+
+#include "SDL2/SDL_mixer.h"
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "math.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Frames mixed at once
+#define MIX_BLOCK 256
+/// Maximum channel count
+#define MIX_MAX_CHANNELS 8
+/// Limiter threshold
+#define LIMITER_THRESHOLD (32767.0f * 0.95f)
+/// Limiter release time in milliseconds
+#define LIMITER_RELEASE_MS 80.0f
+
+/// Voice
+typedef struct
+{
+    const Sint16* data; /// PCM data
+    int length; /// Length in samples
+    int pos; /// Position in samples
+    int loops; /// Plays left, -1 for forever
+    float gain; /// Current gain
+    float target; /// Target gain
+    float step; /// Gain change per frame
+    int bus; /// Bus
+    int priority; /// Priority
+    bool active; /// Is playing
+    bool paused; /// Is paused
+    bool stopping; /// Stop when the gain reaches zero
+    bool emitted; /// Has the first frame been mixed
+    Uint64 requested; /// Time of the mixer_play call
+    Uint16 gen; /// Generation, invalidates old handles
+}
+VOICE;
+
+// Voices
+static VOICE voices[MIXER_MAX_VOICES];
+// Voice count
+static int voiceCount = 0;
+
+// Output format
+static int freq;
+static int channels;
+
+// Mix buffer
+static float acc[MIX_BLOCK * MIX_MAX_CHANNELS];
+
+// Limiter gain & release per frame
+static float limGain;
+static float limRelease;
+
+// Statistics
+static MIXER_STATS stats;
+// Time of the previous callback
+static Uint64 prevCallback;
+// Is initialized
+static bool initialized = false;
+// Guards the voices against the callback. SDL_LockAudio
+// only locks the legacy device, not the one SDL_mixer opens
+static SDL_mutex* lock = NULL;
+
+
+// Get a voice from a handle, NULL if the handle is stale
+static VOICE* get_voice(int handle)
+{
+    if(handle < 0) return NULL;
+
+    int i = handle & 0xFF;
+    if(i >= voiceCount || voices[i].gen != (Uint16)(handle >> 8) || !voices[i].active)
+        return NULL;
+
+    return &voices[i];
+}
+
+
+// Set a gain ramp
+static void set_ramp(VOICE* v, float target, int frames)
+{
+    v->target = target;
+    if(frames <= 0)
+    {
+        v->gain = target;
+        v->step = 0.0f;
+    }
+    else
+    {
+        v->step = (target - v->gain) / (float)frames;
+    }
+}
+
+
+// Should voice a be stolen before voice b. Fading voices
+// go first, then lower priorities, then quieter voices
+static bool steal_before(const VOICE* a, const VOICE* b)
+{
+    if(a->stopping != b->stopping)
+        return a->stopping;
+    if(a->priority != b->priority)
+        return a->priority < b->priority;
+    return a->target < b->target;
+}
+
+
+// Fade out & stop a voice
+static void stop_voice(VOICE* v, int fadeFrames)
+{
+    v->stopping = true;
+    set_ramp(v,0.0f,fadeFrames);
+    if(fadeFrames <= 0 || v->paused)
+        v->active = false;
+}
+
+
+// Mix with a constant gain
+static void mix_constant(float* out, const Sint16* src, int n, float gain)
+{
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256 g = _mm256_set1_ps(gain);
+    __m256 s;
+    for(; i + 8 <= n; i += 8)
+    {
+        s = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i))));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(s,g)));
+    }
+#elif defined(__SSE2__)
+    const __m128 g = _mm_set1_ps(gain);
+    __m128i v, lo, hi;
+    for(; i + 8 <= n; i += 8)
+    {
+        // Sign-extend 16-bit values to 32 bits
+        v = _mm_loadu_si128((const __m128i*)(src + i));
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v,v),16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(v,v),16);
+
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_cvtepi32_ps(lo),g)));
+        _mm_storeu_ps(out + i+4, _mm_add_ps(_mm_loadu_ps(out + i+4), _mm_mul_ps(_mm_cvtepi32_ps(hi),g)));
+    }
+#endif
+
+    for(; i < n; ++ i)
+    {
+        out[i] += (float)src[i] * gain;
+    }
+}
+
+
+// Mix a ramping voice, one frame at a time. Returns
+// the amount of samples mixed
+static int mix_ramp(VOICE* v, float* out, const Sint16* src, int n)
+{
+    int i = 0;
+    int c;
+    for(; i + channels <= n && v->gain != v->target; i += channels)
+    {
+        v->gain += v->step;
+        if((v->step > 0.0f && v->gain >= v->target) || (v->step < 0.0f && v->gain <= v->target))
+        {
+            v->gain = v->target;
+        }
+
+        for(c = 0; c < channels; ++ c)
+        {
+            out[i + c] += (float)src[i + c] * v->gain;
+        }
+    }
+    return i;
+}
+
+
+// Mix a voice to the buffer
+static void mix_voice(VOICE* v, float* out, int n)
+{
+    int done = 0;
+    int count;
+    int ramp;
+    while(done < n && v->active)
+    {
+        // End of the data, loop or stop
+        if(v->pos >= v->length)
+        {
+            if(v->loops > 0) -- v->loops;
+            if(v->loops == 0)
+            {
+                v->active = false;
+                break;
+            }
+            v->pos = 0;
+        }
+
+        count = v->length - v->pos;
+        if(count > n - done) count = n - done;
+
+        ramp = 0;
+        if(v->gain != v->target)
+            ramp = mix_ramp(v, out + done, v->data + v->pos, count);
+
+        if(count - ramp > 0 && v->gain != 0.0f)
+            mix_constant(out + done + ramp, v->data + v->pos + ramp, count - ramp, v->gain);
+
+        v->pos += count;
+        done += count;
+
+        // Faded out
+        if(v->stopping && v->gain <= 0.0f)
+        {
+            v->active = false;
+        }
+    }
+}
+
+
+// Apply the limiter & convert to 16-bit
+static void write_output(Sint16* dst, float* src, int frames)
+{
+    int i, c;
+    float peak, a, target;
+
+    // Limiter, instant attack & smooth release
+    for(i = 0; i < frames; ++ i)
+    {
+        peak = 0.0f;
+        for(c = 0; c < channels; ++ c)
+        {
+            a = fabsf(src[i*channels + c]);
+            if(a > peak) peak = a;
+        }
+
+        target = peak * limGain > LIMITER_THRESHOLD ? LIMITER_THRESHOLD / peak : 1.0f;
+        if(target < limGain)
+            limGain = target;
+        else
+            limGain += (1.0f - limGain) * limRelease;
+
+        if(limGain < 1.0f)
+        {
+            for(c = 0; c < channels; ++ c)
+            {
+                src[i*channels + c] *= limGain;
+            }
+        }
+    }
+
+    // Convert with saturation
+    int n = frames * channels;
+    i = 0;
+#if defined(__SSE2__)
+    __m128i lo, hi;
+    for(; i + 8 <= n; i += 8)
+    {
+        lo = _mm_cvtps_epi32(_mm_loadu_ps(src + i));
+        hi = _mm_cvtps_epi32(_mm_loadu_ps(src + i+4));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo,hi));
+    }
+#endif
+    int v;
+    for(; i < n; ++ i)
+    {
+        v = (int)lrintf(src[i]);
+        if(v > 32767) v = 32767;
+        if(v < -32768) v = -32768;
+        dst[i] = (Sint16)v;
+    }
+}
+
+
+// Latency probe, measure the samples emitted for the first time
+static void probe_latency(Uint64 now)
+{
+    double freq = (double)SDL_GetPerformanceFrequency();
+    float ms;
+    int i = 0;
+    VOICE* v;
+    for(; i < voiceCount; ++ i)
+    {
+        v = &voices[i];
+        if(!v->active || v->paused || v->emitted) continue;
+
+        v->emitted = true;
+        if(v->bus != MIXER_BUS_SAMPLE) continue;
+
+        ms = (float)((double)(now - v->requested) * 1000.0 / freq);
+        stats.latencyAvgMs = (stats.latencyAvgMs * stats.latencyCount + ms) / (float)(stats.latencyCount +1);
+        if(ms > stats.latencyMaxMs) stats.latencyMaxMs = ms;
+        ++ stats.latencyCount;
+    }
+
+    // A callback much later than the buffer length means
+    // the device was starved
+    if(prevCallback != 0 && stats.budgetMs > 0.0f
+     && (double)(now - prevCallback) * 1000.0 / freq > stats.budgetMs * 1.5)
+    {
+        ++ stats.lateCallbacks;
+    }
+    prevCallback = now;
+}
+
+
+// Mix to a stream, the lock must be held
+static void mix(Uint8* stream, int len)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    probe_latency(start);
+
+    Sint16* out = (Sint16*)stream;
+    int frames = len / (int)(sizeof(Sint16) * channels);
+    int block;
+    int i;
+    int active = 0;
+
+    while(frames > 0)
+    {
+        block = frames > MIX_BLOCK ? MIX_BLOCK : frames;
+        memset(acc,0,sizeof(float) * block * channels);
+
+        for(i = 0; i < voiceCount; ++ i)
+        {
+            if(!voices[i].active || voices[i].paused) continue;
+            mix_voice(&voices[i],acc,block * channels);
+        }
+
+        write_output(out,acc,block);
+        out += block * channels;
+        frames -= block;
+    }
+
+    for(i = 0; i < voiceCount; ++ i)
+    {
+        if(voices[i].active) ++ active;
+    }
+
+    // Store statistics
+    float ms = (float)((double)(SDL_GetPerformanceCounter() - start) * 1000.0
+        / (double)SDL_GetPerformanceFrequency());
+    stats.lastMs = ms;
+    stats.avgMs = stats.callbacks == 0 ? ms : stats.avgMs * 0.99f + ms * 0.01f;
+    if(ms > stats.peakMs) stats.peakMs = ms;
+    stats.budgetMs = (float)(len / (int)(sizeof(Sint16) * channels)) * 1000.0f / (float)freq;
+    stats.activeVoices = active;
+    ++ stats.callbacks;
+}
+
+
+// Audio callback
+static void mixer_callback(void* udata, Uint8* stream, int len)
+{
+    SDL_LockMutex(lock);
+    mix(stream,len);
+    SDL_UnlockMutex(lock);
+}
+
+
+// Initialize
+int mixer_init(int count, int bufferFrames, bool hook)
+{
+    Uint16 format;
+    if(Mix_QuerySpec(&freq,&format,&channels) == 0)
+    {
+        printf("Audio device is not open!\n");
+        return 1;
+    }
+    if(format != AUDIO_S16SYS || channels < 1 || channels > MIX_MAX_CHANNELS)
+    {
+        printf("Unsupported audio format!\n");
+        return 1;
+    }
+
+    if(count < 1) count = 1;
+    if(count > MIXER_MAX_VOICES) count = MIXER_MAX_VOICES;
+    voiceCount = count;
+    memset(voices,0,sizeof(voices));
+
+    limGain = 1.0f;
+    limRelease = 1.0f - expf(-1000.0f / (LIMITER_RELEASE_MS * (float)freq));
+    memset(&stats,0,sizeof(MIXER_STATS));
+    stats.rate = freq;
+    stats.bufferFrames = bufferFrames;
+    prevCallback = 0;
+
+    lock = SDL_CreateMutex();
+    if(lock == NULL)
+    {
+        printf("Failed to create the mixer lock: %s\n",SDL_GetError());
+        return 1;
+    }
+
+    // SDL_mixer only drives the device, everything
+    // is mixed in the music hook
+    if(hook)
+        Mix_HookMusic(mixer_callback,NULL);
+    initialized = true;
+
+    return 0;
+}
+
+
+// Start a voice
+int mixer_play(const Sint16* data, int length, float vol, int loops, int fadeFrames, int bus, int priority)
+{
+    if(!initialized || data == NULL || length <= 0) return -1;
+
+    SDL_LockMutex(lock);
+
+    // Find a free voice
+    int i = 0;
+    for(; i < voiceCount && voices[i].active; ++ i);
+    if(i == voiceCount)
+    {
+        // Steal the least important voice
+        int j = 0;
+        int steal = -1;
+        VOICE* c;
+        for(; j < voiceCount; ++ j)
+        {
+            c = &voices[j];
+            if(c->priority > priority) continue;
+            if(steal < 0 || steal_before(c,&voices[steal]))
+            {
+                steal = j;
+            }
+        }
+
+        if(steal < 0)
+        {
+            SDL_UnlockMutex(lock);
+            return -1;
+        }
+        i = steal;
+        ++ stats.stolen;
+    }
+
+    VOICE* v = &voices[i];
+    v->data = data;
+    v->length = length - (length % channels);
+    v->pos = 0;
+    v->loops = loops == 0 ? 1 : loops;
+    v->gain = 0.0f;
+    v->bus = bus;
+    v->priority = priority;
+    v->paused = false;
+    v->stopping = false;
+    v->emitted = false;
+    v->requested = SDL_GetPerformanceCounter();
+    v->active = true;
+    ++ v->gen;
+    set_ramp(v,vol,fadeFrames);
+
+    int handle = ((int)v->gen << 8) | i;
+    SDL_UnlockMutex(lock);
+
+    return handle;
+}
+
+
+// Is playing
+bool mixer_is_playing(int voice)
+{
+    if(!initialized) return false;
+
+    SDL_LockMutex(lock);
+    bool ret = get_voice(voice) != NULL;
+    SDL_UnlockMutex(lock);
+
+    return ret;
+}
+
+
+// Set volume
+void mixer_set_volume(int voice, float vol, int rampFrames)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+    VOICE* v = get_voice(voice);
+    if(v != NULL && !v->stopping)
+        set_ramp(v,vol,rampFrames);
+    SDL_UnlockMutex(lock);
+}
+
+
+// Pause or resume
+void mixer_pause(int voice, bool state)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+    VOICE* v = get_voice(voice);
+    if(v != NULL)
+        v->paused = state;
+    SDL_UnlockMutex(lock);
+}
+
+
+// Stop a voice
+void mixer_stop(int voice, int fadeFrames)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+    VOICE* v = get_voice(voice);
+    if(v != NULL)
+        stop_voice(v,fadeFrames);
+    SDL_UnlockMutex(lock);
+}
+
+
+// Stop a bus
+void mixer_stop_bus(int bus, int fadeFrames)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+    int i = 0;
+    for(; i < voiceCount; ++ i)
+    {
+        if(voices[i].active && voices[i].bus == bus)
+            stop_voice(&voices[i],fadeFrames);
+    }
+    SDL_UnlockMutex(lock);
+}
+
+
+// Milliseconds to frames
+int mixer_ms_to_frames(int ms)
+{
+    return (int)((Sint64)ms * freq / 1000);
+}
+
+
+// Mix outside the callback
+void mixer_render(Sint16* out, int frames)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+    mix((Uint8*)out,frames * channels * (int)sizeof(Sint16));
+    SDL_UnlockMutex(lock);
+}
+
+
+// Advance without mixing
+void mixer_advance(int frames)
+{
+    if(!initialized) return;
+
+    SDL_LockMutex(lock);
+
+    int i = 0;
+    VOICE* v;
+    for(; i < voiceCount; ++ i)
+    {
+        v = &voices[i];
+        if(!v->active || v->paused) continue;
+
+        // Ramp
+        if(v->gain != v->target)
+        {
+            v->gain += v->step * (float)frames;
+            if((v->step > 0.0f && v->gain >= v->target) || (v->step <= 0.0f && v->gain <= v->target))
+                v->gain = v->target;
+        }
+        if(v->stopping && v->gain <= 0.0f)
+        {
+            v->active = false;
+            continue;
+        }
+
+        // Position & loops
+        v->pos += frames * channels;
+        while(v->active && v->pos >= v->length)
+        {
+            if(v->loops > 0) -- v->loops;
+            if(v->loops == 0)
+                v->active = false;
+            else
+                v->pos -= v->length;
+        }
+        v->emitted = true;
+    }
+
+    SDL_UnlockMutex(lock);
+}
+
+
+// Get channel count
+int mixer_get_channels()
+{
+    return channels;
+}
+
+
+// Get statistics
+MIXER_STATS mixer_get_stats()
+{
+    return stats;
+}
+
+
+// Destroy
+void mixer_destroy()
+{
+    if(!initialized) return;
+
+    // The hook is changed with the device locked, so the
+    // callback is not running after this
+    Mix_HookMusic(NULL,NULL);
+    initialized = false;
+    SDL_DestroyMutex(lock);
+    lock = NULL;
+
+    printf("Mixer: %u callbacks, %.3f ms average, %.3f ms peak (%.2f ms of audio each)\n",
+        stats.callbacks,stats.avgMs,stats.peakMs,stats.budgetMs);
+
+    // The emitted buffer still has to wait for the one
+    // being played, hence one buffer on top of the probe
+    if(stats.latencyCount > 0)
+    {
+        printf("Latency: %d Hz, %d frames, trigger to callback %.2f ms average, %.2f ms max, "
+            "~%.2f ms to output, %u late callbacks\n",
+            stats.rate,stats.bufferFrames,stats.latencyAvgMs,stats.latencyMaxMs,
+            stats.latencyAvgMs + stats.budgetMs,stats.lateCallbacks);
+    }
+}
@@ -0,0 +1,124 @@
+/// Software audio mixer (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __MIXER__
+#define __MIXER__
+
+#include "SDL2/SDL.h"
+
+#include "stdbool.h"
+
+/// Default voice count
+#define MIXER_DEFAULT_VOICES 16
+/// Maximum voice count
+#define MIXER_MAX_VOICES 64
+
+/// Voice priority of music, never stolen by samples
+#define MIXER_PRIORITY_MUSIC 1000
+
+/// Voice buses
+enum
+{
+    MIXER_BUS_SAMPLE = 0,
+    MIXER_BUS_MUSIC = 1,
+};
+
+/// Mixer statistics
+typedef struct
+{
+    float lastMs; /// Mix time of the last callback
+    float avgMs; /// Average mix time
+    float peakMs; /// Peak mix time
+    float budgetMs; /// Audio played by one callback
+    Uint32 callbacks; /// Callback count
+    int activeVoices; /// Voices active in the last callback
+    Uint32 stolen; /// Voices stolen for new ones
+
+    int bufferFrames; /// Device buffer size in frames
+    int rate; /// Device sample rate
+    Uint32 lateCallbacks; /// Callbacks that came later than 1.5 buffers
+
+    /// Latency probe: time from mixer_play to the callback
+    /// that emits the first frame of a sample
+    float latencyAvgMs;
+    float latencyMaxMs;
+    Uint32 latencyCount;
+}
+MIXER_STATS;
+
+/// Initialize the mixer. The audio device must be open.
+/// If hooked, the voices are mixed in its callback,
+/// otherwise only by mixer_render & mixer_advance
+/// < voices Voice count
+/// < bufferFrames Device buffer size in frames
+/// < hook Mix in the device callback
+/// > 0 on success, 1 on error
+int mixer_init(int voices, int bufferFrames, bool hook);
+
+/// Start a voice. If all the voices are in use, the one with
+/// the lowest priority (and then the lowest volume) is stolen,
+/// unless its priority is higher than the new one
+/// < data PCM data in the device format
+/// < length Data length in samples
+/// < vol Volume
+/// < loops Times to play, -1 for forever
+/// < fadeFrames Fade-in length in frames
+/// < bus Voice bus
+/// < priority Voice priority
+/// > Voice handle, -1 if no voice available
+int mixer_play(const Sint16* data, int length, float vol, int loops, int fadeFrames, int bus, int priority);
+
+/// Is a voice still playing
+/// < voice Voice handle
+/// > True or false
+bool mixer_is_playing(int voice);
+
+/// Change voice volume
+/// < voice Voice handle
+/// < vol Volume
+/// < rampFrames Ramp length in frames
+void mixer_set_volume(int voice, float vol, int rampFrames);
+
+/// Pause or resume a voice
+/// < voice Voice handle
+/// < state True to pause
+void mixer_pause(int voice, bool state);
+
+/// Fade out & stop a voice
+/// < voice Voice handle
+/// < fadeFrames Fade-out length in frames
+void mixer_stop(int voice, int fadeFrames);
+
+/// Fade out & stop all the voices in a bus
+/// < bus Voice bus
+/// < fadeFrames Fade-out length in frames
+void mixer_stop_bus(int bus, int fadeFrames);
+
+/// Convert milliseconds to frames
+/// < ms Milliseconds
+/// > Frames
+int mixer_ms_to_frames(int ms);
+
+/// Mix frames outside the device callback, for
+/// backends that pull the audio themselves
+/// < out Output buffer in the device format
+/// < frames Frame count
+void mixer_render(Sint16* out, int frames);
+
+/// Advance the voices without mixing them, for
+/// backends that drop the output
+/// < frames Frame count
+void mixer_advance(int frames);
+
+/// Get the output channel count
+/// > Channel count
+int mixer_get_channels();
+
+/// Get mixer statistics
+/// > Statistics
+MIXER_STATS mixer_get_stats();
+
+/// Destroy the mixer
+void mixer_destroy();
+
+#endif // __MIXER__
@@ -3,6 +3,9 @@
 
 #include "music.h"
 
+#include "mixer.h"
+#include "audio.h"
+
 #include "SDL2/SDL.h"
 
 #include "stdbool.h"
@@ -20,15 +23,34 @@ static bool playing;
 static bool musicEnabled;
 // Old volume
 static float oldVol;
+// Music voice
+static int voice;
+// Track in the voice, NULL if stopped
+static MUSIC* current;
+// Is the track faded out (but kept in place)
+static bool fadedOut;
+
+
+// Get the voice gain
+static float get_gain(float vol, int globalVol)
+{
+    float g = vol * (float)globalVol / 100.0f;
+    if(g > 1.0f) g = 1.0f;
+    if(g < 0.0f) g = 0.0f;
+    return g;
+}
 
 
 // Init music
-int init_music()
+int init_music(const CONFIG* c)
 {
     globalMusicVol = 100;
     playing = false;
     musicEnabled = true;
     oldVol = 1.0f;
+    voice = -1;
+    current = NULL;
+    fadedOut = false;
 
     // Init formats
     int flags = MIX_INIT_OGG;
@@ -40,12 +62,21 @@ int init_music()
     }
 
     // Open audio
-    if(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 512)==-1) 
+    if(audio_open(c->audioBackend,c->audioRate,c->audioBuffer,c->audioWav) != 0)
     {
         SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to open audio!\n",NULL);
         return 1;
     }
 
+    // Start the mixer, the null & WAV backends mix
+    // one simulation frame at a time instead of in the
+    // device thread
+    if(mixer_init(c->voices,c->audioBuffer,audio_get_backend() == AUDIO_BACKEND_SDL) != 0)
+    {
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Failed to start the audio mixer!\n",NULL);
+        return 1;
+    }
+
     return 0;
 }   
 
@@ -60,7 +91,8 @@ MUSIC* load_music(const char* path)
         return NULL;
     }
 
-    m->data = Mix_LoadMUS(path);
+    // Decoded once, the mixer plays it like any other voice
+    m->data = Mix_LoadWAV(path);
     if(m->data == NULL)
     {
         char err [64];
@@ -76,19 +108,33 @@ MUSIC* load_music(const char* path)
 // Play music
 void play_music(MUSIC* mus, float vol, int loops)
 {
+    const int FADE_IN = 1000;
+    const int CUT = 64;
+    const int CUT_MS = 20;
+
     if(!musicEnabled) return;
 
     oldVol = vol;
 
-    float mvol = (float)globalMusicVol / 100.0f;
-
-    int v = (int)(128 * vol * mvol);
-    if(v > 128) v = 128;
-    if(v < 0) v = 0;
+    // Same track, keep it going. A faded out track
+    // fades back in from where it was
+    if(mus == current && mixer_is_playing(voice))
+    {
+        mixer_set_volume(voice,get_gain(vol,globalMusicVol),
+            fadedOut ? mixer_ms_to_frames(FADE_IN) : mixer_ms_to_frames(CUT_MS));
+        fadedOut = false;
+        playing = true;
+        return;
+    }
 
-    Mix_HaltMusic();
-    Mix_VolumeMusic(v);
-    Mix_FadeInMusic(mus->data, loops,1000);
+    // The tracks are decoded at load, starting one
+    // does not allocate or decode anything
+    mixer_stop(voice,CUT);
+    current = mus;
+    fadedOut = false;
+    voice = mixer_play((const Sint16*)mus->data->abuf,mus->data->alen / sizeof(Sint16),
+        get_gain(vol,globalMusicVol),loops,mixer_ms_to_frames(FADE_IN),
+        MIXER_BUS_MUSIC,MIXER_PRIORITY_MUSIC);
 
     playing = true;
 }
@@ -99,7 +145,7 @@ void destroy_music(MUSIC* m)
 {
     if(m == NULL) return;
 
-    Mix_FreeMusic(m->data);
+    Mix_FreeChunk(m->data);
     free(m);
 }
 
@@ -109,42 +155,37 @@ void stop_music()
 {
     if(!musicEnabled) return;
 
-    Mix_FadeOutMusic(1000);
+    mixer_stop(voice,mixer_ms_to_frames(1000));
+    current = NULL;
 }
 
 
 // Fade out
 void fade_out_music(int ms)
 {
-    Mix_FadeOutMusic(ms);
+    // Kept in place silently, so that the same
+    // track can continue without a restart
+    mixer_set_volume(voice,0.0f,mixer_ms_to_frames(ms));
+    fadedOut = true;
 }
 
 
 // Enable music
 void enable_music(bool state)
 {
-    if(!state)
-    {
-        Mix_PauseMusic();
-        globalMusicVol = 0;
-    }
-    else
-    {
-        Mix_ResumeMusic();
-        globalMusicVol = 100;
-    }
+    mixer_pause(voice,!state);
+    globalMusicVol = state ? 100 : 0;
     musicEnabled = state;
-    
 }
 
 
 // Set global music volume
 void set_global_music_volume(int vol)
 {
-    float mvol = (float)vol / 100.0f;
-    int v = (int)(128 * oldVol * mvol);
+    const int RAMP = 20;
 
-    Mix_VolumeMusic(v);
+    if(!fadedOut)
+        mixer_set_volume(voice,get_gain(oldVol,vol),mixer_ms_to_frames(RAMP));
 
     globalMusicVol = vol;
 }
@@ -6,23 +6,27 @@
 
 #include "SDL2/SDL_mixer.h"
 
+#include "config.h"
+
 #include "stdbool.h"
 
 /// Music
 typedef struct
 {
-    Mix_Music* data;
+    Mix_Chunk* data; /// Decoded to the device format
 }
 MUSIC;
 
-/// Init music
-int init_music();
+/// Init music & open audio
+/// < c Configuration (audio backend, rate, buffer & voices)
+int init_music(const CONFIG* c);
 
 /// Load music
 /// < path File path
 MUSIC* load_music(const char* path);
 
-/// Play music
+/// Play music. If the track is already playing (or
+/// faded out), it continues from its current position
 /// < mus Music to play
 /// < vol Volume
 /// < loops Loops
@@ -35,7 +39,7 @@ void destroy_music(MUSIC* m);
 /// Stop music
 void stop_music();
 
-/// Fade out music
+/// Fade out music, the track keeps its position
 /// < ms Milliseconds
 void fade_out_music(int ms);
 
@@ -3,15 +3,75 @@
 
 #include "sample.h"
 
+#include "mixer.h"
+
 #include "stdlib.h"
 #include "math.h"
 #include "stdio.h"
+#include "string.h"
 
 // Global volume
 static int globalSoundVol;
 // Samples enabled
 static bool samplesEnabled;
 
+// Frame index
+static Uint32 frameIndex;
+// Counters of the current & previous frame
+static VOICE_COUNTERS counters;
+static VOICE_COUNTERS prevCounters;
+// Stolen voices before this frame
+static Uint32 stolenBase;
+
+// Sample arena, all the sounds in one allocation
+static Uint8* arenaMem = NULL;
+static Sint16* arena = NULL;
+// Arena size & capacity in 16-bit samples
+static int arenaSize = 0;
+static int arenaCapacity = 0;
+
+
+// Get the arena base, aligned to SAMPLE_ALIGN
+static Sint16* align_arena(Uint8* mem)
+{
+    size_t addr = (size_t)mem;
+    return (Sint16*)(mem + ((SAMPLE_ALIGN - addr % SAMPLE_ALIGN) % SAMPLE_ALIGN));
+}
+
+
+// Make room for more samples in the arena
+static int grow_arena(int size)
+{
+    if(size <= arenaCapacity) return 0;
+
+    int cap = arenaCapacity > 0 ? arenaCapacity : 65536;
+    while(cap < size)
+    {
+        cap *= 2;
+    }
+
+    // The memory may move, no voice can be reading it
+    mixer_stop_bus(MIXER_BUS_SAMPLE,0);
+
+    int shift = arena == NULL ? 0 : (int)((Uint8*)arena - arenaMem);
+    Uint8* mem = (Uint8*)realloc(arenaMem,sizeof(Sint16) * cap + SAMPLE_ALIGN);
+    if(mem == NULL)
+        return 1;
+
+    // Keep the data aligned after realloc
+    Sint16* base = align_arena(mem);
+    if((Uint8*)base - mem != shift)
+    {
+        memmove(base,mem + shift,sizeof(Sint16) * arenaSize);
+    }
+
+    arenaMem = mem;
+    arena = base;
+    arenaCapacity = cap;
+
+    return 0;
+}
+
 
 // Init audio
 void init_samples()
@@ -19,6 +79,11 @@ void init_samples()
     // Set default values
     globalSoundVol = 100;
     samplesEnabled = true;
+
+    frameIndex = 1;
+    counters = (VOICE_COUNTERS){0,0,0,0};
+    prevCounters = counters;
+    stolenBase = 0;
 }
 
 
@@ -33,25 +98,48 @@ void set_global_sample_volume(int vol)
 SAMPLE* load_sample(const char* path)
 {
     // Allocate memory
-    SAMPLE * s = (SAMPLE*)malloc(sizeof(s));
+    SAMPLE * s = (SAMPLE*)malloc(sizeof(SAMPLE));
     if(s == NULL)
     {
         printf("Memory allocation error!\n");
         return NULL;
     }
 
-    // Load WAV
-    s->chunk =Mix_LoadWAV(path);
-    if(!s->chunk) 
+    // Load WAV, decoded to the device format
+    Mix_Chunk* chunk = Mix_LoadWAV(path);
+    if(!chunk) 
     {
         printf("Failed to load a sound in %s!\n",path);
         free(s);
         return NULL;
     }
 
+    // Copy to the arena, each sample starts aligned
+    const int ALIGN = SAMPLE_ALIGN / sizeof(Sint16);
+    int offset = (arenaSize + ALIGN-1) / ALIGN * ALIGN;
+    int length = chunk->alen / sizeof(Sint16);
+    if(grow_arena(offset + length) != 0)
+    {
+        printf("Memory allocation error!\n");
+        Mix_FreeChunk(chunk);
+        free(s);
+        return NULL;
+    }
+    memcpy(arena + offset,chunk->abuf,sizeof(Sint16) * length);
+    Mix_FreeChunk(chunk);
+
+    s->offset = offset;
+    s->length = length;
+    arenaSize = offset + length;
+
+    printf("%s: %d bytes, %d bytes in the sample arena\n",
+        path,length * (int)sizeof(Sint16),arenaSize * (int)sizeof(Sint16));
+
     // Set default values
-    s->channel = 0;
-    s->played = false;
+    s->voice = -1;
+    s->priority = SAMPLE_DEFAULT_PRIORITY;
+    s->frame = 0;
+    s->frameGain = 0.0f;
 
     return s;
 }
@@ -60,35 +148,70 @@ SAMPLE* load_sample(const char* path)
 // Play sound
 void play_sample(SAMPLE* s, float vol)
 {
+    // Short fade-out for a retriggered sound, avoids clicks
+    const int RETRIGGER_FADE = 64;
+
     if(s == NULL || !samplesEnabled) return;
 
+    ++ counters.requested;
+
     float svol = (float)globalSoundVol / 100.0f;
 
-    if(!s->played)
+    // Already triggered in this frame, make the voice louder
+    // instead of starting another one
+    if(s->frame == frameIndex && mixer_is_playing(s->voice))
     {
-        // Get channel, halt, set volume, play again
-        s->channel = Mix_PlayChannel(-1,s->chunk,0);
-        Mix_HaltChannel(s->channel);
+        s->frameGain += vol * svol;
+        if(s->frameGain > 1.0f) s->frameGain = 1.0f;
 
-        Mix_Volume(s->channel,(int)(MIX_MAX_VOLUME * vol * svol));
-        Mix_PlayChannel(-1,s->chunk,0);
-        
-
-        s->played = true;
-    }
-    else
-    {
-        Mix_HaltChannel(s->channel);
-        Mix_Volume(s->channel,(int)(MIX_MAX_VOLUME * vol * svol));
-        Mix_PlayChannel(s->channel,s->chunk,0);
+        mixer_set_volume(s->voice,s->frameGain,0);
+        ++ counters.merged;
+        return;
     }
+
+    // A sample plays in one voice at a time
+    mixer_stop(s->voice,RETRIGGER_FADE);
+    s->frame = frameIndex;
+    s->frameGain = vol * svol;
+    s->voice = mixer_play(arena + s->offset,s->length,
+        s->frameGain,1,0,MIXER_BUS_SAMPLE,s->priority);
+
+    if(s->voice < 0)
+        ++ counters.dropped;
+}
+
+
+// Set priority
+void set_sample_priority(SAMPLE* s, int priority)
+{
+    s->priority = priority;
+}
+
+
+// End the frame
+void update_samples()
+{
+    Uint32 stolen = mixer_get_stats().stolen;
+    counters.stolen = (int)(stolen - stolenBase);
+    stolenBase = stolen;
+
+    prevCounters = counters;
+    counters = (VOICE_COUNTERS){0,0,0,0};
+    ++ frameIndex;
+}
+
+
+// Get counters
+VOICE_COUNTERS get_sample_counters()
+{
+    return prevCounters;
 }
 
 
 // Stop all samples
 void stop_all_samples()
 {
-    Mix_HaltChannel(-1);
+    mixer_stop_bus(MIXER_BUS_SAMPLE,0);
 }
 
 
@@ -97,11 +220,35 @@ void destroy_sample(SAMPLE* s)
 {
     if(s == NULL) return;
 
-    Mix_FreeChunk(s->chunk);
+    mixer_stop(s->voice,0);
     free(s);
 }
 
 
+// Free the arena
+void destroy_sample_arena()
+{
+    if(arenaMem == NULL) return;
+
+    printf("Sample arena: %d bytes allocated, %d bytes in use\n",
+        get_sample_arena_size(),arenaSize * (int)sizeof(Sint16));
+
+    mixer_stop_bus(MIXER_BUS_SAMPLE,0);
+    free(arenaMem);
+    arenaMem = NULL;
+    arena = NULL;
+    arenaSize = 0;
+    arenaCapacity = 0;
+}
+
+
+// Get arena size
+int get_sample_arena_size()
+{
+    return arenaMem == NULL ? 0 : arenaCapacity * (int)sizeof(Sint16) + SAMPLE_ALIGN;
+}
+
+
 // Enable/disable samples
 void enable_samples(bool state)
 {
@@ -9,15 +9,33 @@
 
 #include "stdbool.h"
 
-/// Sound effect type
+/// Default sample priority
+#define SAMPLE_DEFAULT_PRIORITY 0
+/// Alignment of the samples in the arena, in bytes
+#define SAMPLE_ALIGN 64
+
+/// Sound effect type, a view into the sample arena
 typedef struct
 {
-    Mix_Chunk* chunk; /// Chunk
-    int channel; /// Channel
-    bool played; /// Has the sound been played at least once
+    int offset; /// Offset in the arena, in 16-bit samples
+    int length; /// Length in 16-bit samples
+    int voice; /// Mixer voice, -1 if not playing
+    int priority; /// Voice priority
+    Uint32 frame; /// Frame of the last trigger
+    float frameGain; /// Gain summed in the frame of the last trigger
 }
 SAMPLE;
 
+/// Voice counters of one frame
+typedef struct
+{
+    int requested; /// play_sample calls
+    int merged; /// Calls merged to a voice started in the same frame
+    int dropped; /// Calls that got no voice
+    int stolen; /// Voices stolen for new ones
+}
+VOICE_COUNTERS;
+
 /// Init sample
 void init_samples();
 
@@ -25,7 +43,8 @@ void init_samples();
 /// < vol Volume in range 0-100
 void set_global_sample_volume(int vol);
 
-/// Load a sample
+/// Load a sample. The sound is decoded to the device
+/// format and appended to the sample arena
 /// < path Path
 /// > A new sound
 SAMPLE* load_sample(const char* path);
@@ -35,6 +54,19 @@ SAMPLE* load_sample(const char* path);
 /// < vol Volume
 void play_sample(SAMPLE* s, float vol);
 
+/// Set sample priority, used when voices run out
+/// < s Sample
+/// < priority Priority
+void set_sample_priority(SAMPLE* s, int priority);
+
+/// End the sample frame. Samples triggered within
+/// the same frame are merged
+void update_samples();
+
+/// Get the voice counters of the previous frame
+/// > Counters
+VOICE_COUNTERS get_sample_counters();
+
 /// Stop all samples
 void stop_all_samples();
 
@@ -42,6 +74,13 @@ void stop_all_samples();
 /// < s Sample to destroy
 void destroy_sample(SAMPLE* s);
 
+/// Free the sample arena. Destroy the samples first
+void destroy_sample_arena();
+
+/// Get the memory used by the sample arena
+/// > Bytes allocated
+int get_sample_arena_size();
+
 /// Enable/disable samples
 void enable_samples(bool state);
 
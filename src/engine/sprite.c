@@ -3,8 +3,6 @@
 
 #include "sprite.h"
 
-#include "graphics.h"
-
 #include "stdlib.h"
 #include "math.h"
 #include "stdio.h"
@@ -66,15 +64,3 @@ void spr_animate(SPRITE*s, int row, int start, int end, float speed, float tm)
 		s->count -= speed;
 	}
 }
-
-/// Draw a sprite frame
-void spr_draw_frame(SPRITE*s, BITMAP* bmp, int frame, int row, int x, int y, int flip)
-{
-    draw_bitmap_region(bmp,s->w*frame,s->h*row,s->w,s->h,x,y,flip);
-}
-
-/// Draw a sprite
-void spr_draw(SPRITE* s, BITMAP* bmp, int x, int y, int flip)
-{
-    spr_draw_frame(s,bmp,s->frame,s->row,x,y,flip);
-}
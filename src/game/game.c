@@ -17,16 +17,27 @@
 
 #include "../menu/menu.h"
 
-#include "stage.h"
-#include "objects.h"
-#include "status.h"
+#include "../sim/sim.h"
+#include "../sim/stage.h"
+#include "../sim/status.h"
+#include "../sim/turn.h"
+#include "../sim/undo.h"
+
+#include "render.h"
+#include "hud.h"
 #include "pause.h"
+#include "record.h"
 
 #include "stdio.h"
 #include "stdlib.h"
 #include "math.h"
 #include "time.h"
 
+// Game context
+static GAME_CONTEXT context;
+// Undo history
+static UNDO* undo;
+
 // Theme music
 static MUSIC* mTheme;
 // Final music
@@ -35,6 +46,14 @@ static MUSIC* mFinal;
 // Sound effects
 static SAMPLE* sPause;
 static SAMPLE* sRestart;
+static SAMPLE* sJump;
+static SAMPLE* sDie;
+static SAMPLE* sPush;
+static SAMPLE* sThwomp;
+static SAMPLE* sTransf;
+static SAMPLE* sKey;
+static SAMPLE* sOpen;
+static SAMPLE* sCoin;
 
 // Bitmaps
 static BITMAP* bmpHelp;
@@ -87,16 +106,80 @@ static void update_help(float tm)
 }
 
 
+// Simulation event, play the sounds & transitions
+static void on_sim_event(const SIM_EVENT* ev, void* data)
+{
+    switch(ev->type)
+    {
+    case SIM_EVENT_JUMP:
+        play_sample(sJump,0.40f);
+        break;
+
+    case SIM_EVENT_DEATH:
+        fade_out_music(500);
+        break;
+
+    case SIM_EVENT_DEATH_HIT:
+        render_shake(60.0f);
+        play_sample(sDie,0.40f);
+        break;
+
+    case SIM_EVENT_DEATH_END:
+        trn_set(FADE_IN,BLACK_VERTICAL,1.0f,game_reset);
+        break;
+
+    case SIM_EVENT_PUSH:
+        play_sample(sPush,0.60f);
+        break;
+
+    case SIM_EVENT_THWOMP:
+        play_sample(sThwomp,0.60f);
+        break;
+
+    case SIM_EVENT_TRANSFORM:
+        play_sample(sTransf,0.50f);
+        break;
+
+    case SIM_EVENT_KEY:
+        play_sample(sKey,0.50f);
+        break;
+
+    case SIM_EVENT_LOCK:
+        play_sample(sOpen,0.60f);
+        break;
+
+    case SIM_EVENT_COIN:
+        play_sample(sCoin,0.50f);
+        break;
+
+    case SIM_EVENT_VICTORY:
+        record_on_victory();
+        hud_on_victory((GAME_CONTEXT*)data);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
 // Init game
 static int game_init()
 {
     ASSET_PACK* ass = get_global_assets();
 
     // Initialize game components
-    obj_init(ass);
-    stage_init(ass);
-    status_init(ass);
+    render_init(ass);
+    hud_init(ass);
     pause_init(ass);
+    sim_init(&context);
+    sim_set_observer(&context,on_sim_event,&context);
+
+    undo = undo_create(UNDO_DEFAULT_SIZE);
+    if(undo == NULL)
+    {
+        return 1;
+    }
 
     // Get assets
     mTheme = (MUSIC*)get_asset(ass,"theme");
@@ -104,6 +187,14 @@ static int game_init()
 
     sPause = (SAMPLE*)get_asset(ass,"pause");
     sRestart = (SAMPLE*)get_asset(ass,"restart");
+    sJump = (SAMPLE*)get_asset(ass,"jump");
+    sDie = (SAMPLE*)get_asset(ass,"die");
+    sPush = (SAMPLE*)get_asset(ass,"push");
+    sThwomp = (SAMPLE*)get_asset(ass,"thwomp");
+    sTransf = (SAMPLE*)get_asset(ass,"transf");
+    sKey = (SAMPLE*)get_asset(ass,"getKey");
+    sOpen = (SAMPLE*)get_asset(ass,"openLock");
+    sCoin = (SAMPLE*)get_asset(ass,"getCoin");
 
     bmpHelp = (BITMAP*)get_asset(ass,"help");
 
@@ -116,6 +207,27 @@ static int game_init()
 }
 
 
+// Record finished turns & undo or redo them. A restart
+// is recorded like any turn, so it can be undone, too
+static void update_undo()
+{
+    if(!turn_is_settled(&context) || status_is_victory(&context)
+        || obj_get_player(&context)->dying)
+        return;
+
+    undo_record(undo,&context);
+
+    int ret = 1;
+    if(vpad_get_button(4) == PRESSED)
+        ret = undo_undo(undo,&context);
+    else if(vpad_get_button(5) == PRESSED)
+        ret = undo_redo(undo,&context);
+
+    if(ret == 0)
+        play_sample(sPause,0.30f);
+}
+
+
 // Update game
 static void game_update(float tm)
 {
@@ -123,8 +235,8 @@ static void game_update(float tm)
     if(trn_is_active())
         return;
 
-    // Show help if not yet shown
-    if(!helpShown)
+    // Show help if not yet shown, not when playing back
+    if(!helpShown && !record_is_playing())
     {
         update_help(tm);
         return;
@@ -137,10 +249,15 @@ static void game_update(float tm)
         return;
     }
 
+    // The input of a replay replaces the real one
+    tm = record_frame(tm);
+
     // Update game components
-    stage_update(tm);
-    obj_update(tm);
-    status_update(tm);
+    SIM_INPUT in = (SIM_INPUT){vpad_get_stick(),vpad_get_button(0)};
+    render_update(tm);
+    sim_tick(&context,&in,tm);
+    update_undo();
+    hud_update(&context,tm);
 
     // Reset if the reset button is pressed
     if(vpad_get_button(2) == PRESSED)
@@ -150,11 +267,13 @@ static void game_update(float tm)
     }
 
     // Pause if the pause or escape button is pressed
-    if(!status_is_victory() && (vpad_get_button(1) == PRESSED || vpad_get_button(3) == PRESSED) )
+    if(!status_is_victory(&context) && (vpad_get_button(1) == PRESSED || vpad_get_button(3) == PRESSED) )
     {
         play_sample(sPause,0.30f);
         pause_enable();
     }
+
+    record_end_frame(&context);
 }
 
 
@@ -162,9 +281,8 @@ static void game_update(float tm)
 static void game_draw()
 {
     // Draw game components
-    stage_draw();
-    obj_draw();
-    status_draw();
+    render_draw(&context);
+    hud_draw(&context);
     pause_draw();
 
     // Draw help
@@ -179,7 +297,9 @@ static void game_draw()
 // Destroy game
 static void game_destroy()
 {
-
+    sim_destroy(&context);
+    undo_destroy(undo);
+    record_destroy();
 }
 
 
@@ -191,25 +311,44 @@ static void game_on_swap()
 }
 
 
-// Set stage
-void game_set_stage(STAGE_INFO info)
+// Load the stage map & create objects
+static void load_stage(TILEMAP* map)
 {
-    // Clear objects
-    obj_clear();
+    if(sim_load(&context,map) != 0)
+    {
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
+        app_terminate();
+        return;
+    }
+    undo_begin(undo,&context);
+}
 
-    // Set map
-    stage_set_main_stage(info.assetName);
 
+// Set stage
+void game_set_stage(int index, STAGE_INFO info)
+{
     // Set stage name
-    status_set_stage_name(info.name);
+    hud_set_stage_name(info.name);
     // Set stage turn target
-    status_set_turn_target(info.turnCount);
+    status_set_turn_target(&context,info.turnCount);
 
-    // Create objects
-    stage_reset(false);
+    // Set map & create objects
+    load_stage((TILEMAP*)get_asset(get_global_assets(),info.assetName));
 
     // Reset
     game_reset();
+
+    // Record or play back from the start
+    record_begin(index);
+}
+
+
+// Reset game components
+static void reset_components()
+{
+    sim_reset(&context);
+    render_reset();
+    hud_reset(&context,true);
 }
 
 
@@ -217,12 +356,23 @@ void game_set_stage(STAGE_INFO info)
 void game_reset()
 {
     // Reset components
-    stage_reset(true);
-    status_reset(true);
-    obj_reset();
+    reset_components();
+    record_on_reset();
 
     // Reset music
-    play_music(status_get_if_final() ? mFinal : mTheme,0.70f,-1);
+    play_music(hud_get_if_final() ? mFinal : mTheme,0.70f,-1);
+}
+
+
+// An asset was reloaded from the disk
+void game_on_asset_reload(void* obj)
+{
+    // Other assets are reloaded in place, only
+    // a changed map needs the stage to be rebuilt
+    if(!stage_is_main_map(&context,obj)) return;
+
+    load_stage((TILEMAP*)obj);
+    reset_components();
 }
 
 
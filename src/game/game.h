@@ -9,12 +9,17 @@
 #include "../menu/info.h"
 
 /// Set game stage
+/// < index Stage index
 /// < info Stage info
-void game_set_stage(STAGE_INFO info);
+void game_set_stage(int index, STAGE_INFO info);
 
 /// Reset game
 void game_reset();
 
+/// Rebuild the stage if its map was reloaded
+/// < obj Reloaded asset
+void game_on_asset_reload(void* obj);
+
 /// Swap game scene to the stage menu
 void swap_to_stage_menu();
 
@@ -1,7 +1,7 @@
-/// Status (source)
+/// HUD (source)
 /// (c) 2018 Jani Nykänen
 
-#include "status.h"
+#include "hud.h"
 
 #include "../engine/graphics.h"
 #include "../engine/music.h"
@@ -11,8 +11,9 @@
 #include "../transition.h"
 #include "../savedata.h"
 
+#include "../sim/status.h"
+
 #include "game.h"
-#include "stage.h"
 
 #include "stdlib.h"
 #include "math.h"
@@ -44,8 +45,6 @@ static MUSIC* mClear;
 static SAMPLE* sAccept;
 static SAMPLE* sSelect;
 
-// Key count
-static int keyCount;
 // Previous key count
 static int prevKeyCount;
 // Key remove pos
@@ -53,10 +52,6 @@ static float keyRemovePos;
 // Is removing a key
 static bool removingKey;
 
-// Turn count
-static int turnCount;
-// Target turns
-static int turnTarget;
 // Turn string
 static char turnString[TURN_STRING_SIZE];
 
@@ -65,8 +60,6 @@ static char stageName[STAGE_NAME_SIZE];
 
 // Victory timer
 static float vicTimer;
-// Is victory reached
-static bool victory;
 // Victory phase
 static int vicPhase;
 // Cursor position
@@ -169,9 +162,9 @@ static void draw_menu(int tx, int ty)
 
 
 // Draw victory
-static void draw_victory()
+static void draw_victory(GAME_CONTEXT* ctx)
 {
-    int starType = (turnCount <= turnTarget) ? 1 : 0;
+    int starType = 1 - status_star_type(ctx);
 
     float t = 1.0f;
     if(vicPhase == 0)
@@ -196,8 +189,8 @@ static void draw_victory()
 }
 
 
-// Initialize status
-void status_init(ASSET_PACK* ass)
+// Initialize HUD
+void hud_init(ASSET_PACK* ass)
 {
     // Get assets
     bmpFont = (BITMAP*)get_asset(ass,"font");
@@ -213,50 +206,48 @@ void status_init(ASSET_PACK* ass)
 
     // Set default values
     isFinal = false;
-    status_reset(false);
+    hud_reset(NULL,false);
 }
 
 
-// Reset status
-void status_reset(bool soft)
+// Reset HUD
+void hud_reset(GAME_CONTEXT* ctx, bool soft)
 {
     // Set default values
-    keyCount = 0;
     prevKeyCount = 0;
     removingKey = false;
     keyRemovePos = 0.0f;
     vicTimer = 0.0f;
     vicPhase = 0;
-    victory = false;
-    turnCount = 0;
     cursorPos = 0;
     cursorWave = 0.0f;
 
     if(!soft)
     {
-        turnTarget = 0;
         snprintf(stageName,STAGE_NAME_SIZE," ");
     }
     else
     {
-        snprintf(turnString,TURN_STRING_SIZE,"%d/%d",turnCount,turnTarget);
+        snprintf(turnString,TURN_STRING_SIZE,"%d/%d",
+            status_get_turn_count(ctx),status_get_turn_target(ctx));
     }
 }
 
 
-// Update status
-void status_update(float tm)
+// Update HUD
+void hud_update(GAME_CONTEXT* ctx, float tm)
 {
     const float REMOVE_SPEED = 1.0f;
 
     // If victory, no need to update the status, just update
     // the victory screen
-    if(victory)
+    if(status_is_victory(ctx))
     {
         update_victory(tm);
         return;
     }
 
+    int keyCount = status_get_key_count(ctx);
     if(!removingKey && prevKeyCount > keyCount)
     {
         removingKey = true;
@@ -273,15 +264,17 @@ void status_update(float tm)
 
     prevKeyCount = keyCount;
 
-    snprintf(turnString,TURN_STRING_SIZE,"%d/%d",turnCount,turnTarget);
+    snprintf(turnString,TURN_STRING_SIZE,"%d/%d",
+        status_get_turn_count(ctx),status_get_turn_target(ctx));
     
 }
 
 
-// Draw status
-void status_draw()
+// Draw HUD
+void hud_draw(GAME_CONTEXT* ctx)
 {
     int i = 0;
+    int keyCount = status_get_key_count(ctx);
 
     // Draw stage name
     draw_text_with_borders(bmpFont,(Uint8*)stageName,-1,128,4,0,0,true);
@@ -300,7 +293,7 @@ void status_draw()
     draw_bitmap_region(bmpIcons,0,0,16,16,192,0,0);
 
     // If turn count pass turn target
-    if(turnCount > turnTarget)
+    if(status_get_turn_count(ctx) > status_get_turn_target(ctx))
         set_bitmap_color(bmpFont,rgb(255,0,0));
         
     draw_text_with_borders(bmpFont,(Uint8*)turnString,-1,210,5,-1,0,false);
@@ -308,61 +301,23 @@ void status_draw()
     set_bitmap_color(bmpFont,rgb(255,255,255));
 
     // Draw victory, if victorous
-    if(victory)
+    if(status_is_victory(ctx))
     {
-        draw_victory();
+        draw_victory(ctx);
     }
 }
 
 
-// Add key
-void status_add_key()
-{
-    ++ keyCount;
-}
-
-
-// Remove key
-void status_remove_key()
-{
-    if(keyCount > 0)
-        -- keyCount;
-}
-
-
-// Get key count
-int status_get_key_count()
-{
-    return keyCount;
-}
-
-
 // Set name
-void status_set_stage_name(const char* name)
+void hud_set_stage_name(const char* name)
 {
     snprintf(stageName,STAGE_NAME_SIZE,"%s",name);
 }
 
 
-// Add turn
-void status_add_turn()
+// Victory reached
+void hud_on_victory(GAME_CONTEXT* ctx)
 {
-    ++ turnCount;
-    stage_toggle_electricity();
-}
-
-
-// Set turn target
-void status_set_turn_target(int target)
-{
-    turnTarget = target;
-}
-
-
-// Activate
-void status_activate_victory()
-{
-    victory = true;
     vicTimer = 0.0f;
     vicPhase = 0;
 
@@ -372,48 +327,34 @@ void status_activate_victory()
     // Set stage completion state to the save data
     SAVEDATA* sd = get_global_save_data();
     int s = sd->stages[stageIndex];
-    int t = turnCount <= turnTarget ? 2 : 1;
+    int t = status_star_type(ctx) == 0 ? 2 : 1;
     if(t > s) sd->stages[stageIndex] = t;
 }
 
 
-// Is victory
-bool status_is_victory()
-{
-    return victory;
-}
-
-
-// Get the start type
-int status_star_type()
-{
-    return (turnCount <= turnTarget) ? 0 : 1;
-}
-
-
 // Set if the stage is the final stage
-void status_set_if_final(bool state)
+void hud_set_if_final(bool state)
 {
     isFinal = state;
 }
 
 
 // Get if the stage is the final stage
-bool status_get_if_final()
+bool hud_get_if_final()
 {
     return isFinal;
 }
 
 
 // Set stage index
-void status_set_stage_index(int index)
+void hud_set_stage_index(int index)
 {
     stageIndex = index;
 }
 
 
 // Get amount of golden stars
-int status_get_star_count(int type)
+int hud_get_star_count(int type)
 {
     int count = 0;
     int i = 0;
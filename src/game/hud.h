@@ -0,0 +1,56 @@
+/// HUD (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __HUD__
+#define __HUD__
+
+#include "../engine/assets.h"
+
+#include "../sim/obase.h"
+
+#include "stdbool.h"
+
+/// Initialize HUD
+/// < ass Asset pack
+void hud_init(ASSET_PACK* ass);
+
+/// Reset HUD
+/// < ctx Game context, only read on a soft reset
+/// < soft Is a soft reset
+void hud_reset(GAME_CONTEXT* ctx, bool soft);
+
+/// Update HUD & the victory screen
+/// < ctx Game context
+/// < tm Time mul.
+void hud_update(GAME_CONTEXT* ctx, float tm); 
+
+/// Draw HUD
+/// < ctx Game context
+void hud_draw(GAME_CONTEXT* ctx);
+
+/// Set stage name
+/// < name New name
+void hud_set_stage_name(const char* name);
+
+/// Victory reached, start the victory screen
+/// < ctx Game context
+void hud_on_victory(GAME_CONTEXT* ctx);
+
+/// Set if the stage is the final stage
+/// < state State
+void hud_set_if_final(bool state);
+
+/// Get if the stage is the final stage
+/// > True or false
+bool hud_get_if_final();
+
+/// Set stage index
+/// < index Index
+void hud_set_stage_index(int index);
+
+/// Get amount of golden stars
+/// < type (1 == bronze, 2 == golden)
+/// > Amount
+int hud_get_star_count(int type);
+
+#endif // __HUD__
\ No newline at end of file
@@ -0,0 +1,226 @@
+/// Session recording & playback (source)
+/// (c) 2018 Jani Nykänen
+
+#include "record.h"
+
+#include "../sim/sim.h"
+#include "../sim/replay.h"
+
+#include "../vpad.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+// Path size
+#define PATH_SIZE 256
+
+// Replay being recorded or played back
+static REPLAY* replay;
+// Record file
+static char recordPath[PATH_SIZE];
+// Is recording
+static bool recording;
+// Is playing back
+static bool playing;
+// Stage to start the playback in
+static int playbackStage = -1;
+// Has the replay been saved
+static bool saved;
+// Was the stage won in this frame
+static bool won;
+
+
+// Save the recording
+static void save()
+{
+    if(!recording || replay == NULL || saved || replay->frameCount == 0)
+        return;
+
+    if(replay_save(replay,recordPath) != 0)
+        printf("Failed to save a replay to %s\n",recordPath);
+    saved = true;
+}
+
+
+// Set the vpad state from a frame
+static void apply_frame(const REPLAY_FRAME* f)
+{
+    int buttons[VPAD_OVERRIDE_BUTTONS];
+    int i = 0;
+
+    for(; i < VPAD_OVERRIDE_BUTTONS; ++ i)
+    {
+        buttons[i] = i < REPLAY_BUTTONS ? replay_frame_button(f,i) : UP;
+    }
+    vpad_override(replay_frame_stick(f),buttons);
+}
+
+
+// Init
+void record_init(const char* recPath, const char* playPath)
+{
+    if(playPath != NULL)
+    {
+        replay = replay_load(playPath);
+        if(replay == NULL)
+        {
+            printf("Failed to load a replay from %s\n",playPath);
+            return;
+        }
+        if(replay->build != replay_build_hash())
+            printf("The replay was recorded with another build\n");
+
+        playbackStage = replay->stage;
+    }
+    else if(recPath != NULL)
+    {
+        snprintf(recordPath,PATH_SIZE,"%s",recPath);
+        recording = true;
+    }
+}
+
+
+// Take playback stage
+int record_take_playback_stage()
+{
+    int stage = playbackStage;
+    playbackStage = -1;
+
+    return stage;
+}
+
+
+// Is playing
+bool record_is_playing()
+{
+    return playing;
+}
+
+
+// Begin
+void record_begin(int stage)
+{
+    if(recording)
+    {
+        save();
+        replay_destroy(replay);
+
+        unsigned int seed = (unsigned int)time(NULL);
+        replay = replay_create(stage,seed);
+        saved = false;
+        srand(seed);
+    }
+    else if(replay != NULL)
+    {
+        // Play back only in the recorded stage
+        playing = stage == replay->stage;
+        if(playing)
+        {
+            replay_rewind(replay);
+            srand(replay->seed);
+        }
+    }
+}
+
+
+// Reset
+void record_on_reset()
+{
+    if(recording && replay != NULL && replay->finished)
+        record_begin(replay->stage);
+}
+
+
+// Frame
+float record_frame(float tm)
+{
+    const float TM = 1.0f;
+
+    REPLAY_FRAME f;
+    int buttons[REPLAY_BUTTONS];
+    int i = 0;
+
+    if(recording && replay != NULL && !replay->finished)
+    {
+        for(; i < REPLAY_BUTTONS; ++ i)
+        {
+            buttons[i] = vpad_get_button(i);
+        }
+        f = replay_make_frame(vpad_get_stick(),buttons);
+        if(replay_push(replay,&f) != 0)
+        {
+            printf("Out of memory, the recording is stopped\n");
+            recording = false;
+            return tm;
+        }
+
+        // Play the quantized input, the same that is played back
+        apply_frame(&f);
+        return TM;
+    }
+    else if(playing)
+    {
+        if(replay_next(replay,&f))
+        {
+            apply_frame(&f);
+            return TM;
+        }
+
+        printf("The replay ended without a victory\n");
+        playing = false;
+    }
+
+    return tm;
+}
+
+
+// End frame
+void record_end_frame(GAME_CONTEXT* ctx)
+{
+    int turns = status_get_turn_count(ctx);
+    unsigned long long hash = sim_get_hash(ctx);
+
+    vpad_release_override();
+
+    if(recording && replay != NULL && !replay->finished)
+    {
+        // The trace is taken in the end of the frame, before
+        // any reset, like the playback does
+        if(replay_trace(replay,replay->frameCount,(unsigned int)hash) != 0)
+        {
+            printf("Out of memory, the recording is stopped\n");
+            recording = false;
+        }
+        else if(won)
+        {
+            replay_finish(replay,true,turns,hash);
+            save();
+        }
+    }
+    else if(playing && won)
+    {
+        bool ok = replay->finished && replay->victory
+            && replay->turns == turns && replay->hash == hash;
+        printf("Replay %s: victory in %d turns, recorded %d\n",
+            ok ? "matches" : "DIVERGED",turns,replay->turns);
+        playing = false;
+    }
+    won = false;
+}
+
+
+// Victory
+void record_on_victory()
+{
+    won = true;
+}
+
+
+// Destroy
+void record_destroy()
+{
+    save();
+    replay_destroy(replay);
+    replay = NULL;
+}
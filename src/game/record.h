@@ -0,0 +1,52 @@
+/// Session recording & playback (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __RECORD__
+#define __RECORD__
+
+#include "../sim/obase.h"
+
+#include "stdbool.h"
+
+/// Set the replay files. Every stage played is recorded
+/// to the record file, overwriting the previous one. The
+/// play file is played back instead of the real input
+/// < recordPath Record file, NULL if not recording
+/// < playPath Play file, NULL if not playing back
+void record_init(const char* recordPath, const char* playPath);
+
+/// Take the stage of the replay to be played back, once
+/// > Stage index, -1 if none
+int record_take_playback_stage();
+
+/// Is a replay being played back
+/// > True or false
+bool record_is_playing();
+
+/// A stage was started
+/// < stage Stage index
+void record_begin(int stage);
+
+/// The stage was reset, a new attempt is recorded if the
+/// last one has ended
+void record_on_reset();
+
+/// Set the input of a game tick, recorded or played back.
+/// Replays use a fixed time step so they do not depend
+/// on the frame rate
+/// < tm Time mul. of the frame
+/// > Time mul. for the tick
+float record_frame(float tm);
+
+/// End the game tick, the real input is used again. The
+/// state hash is traced & a victory is stored or compared
+/// < ctx Game context
+void record_end_frame(GAME_CONTEXT* ctx);
+
+/// The stage was won in this tick
+void record_on_victory();
+
+/// Save the unfinished recording & free memory
+void record_destroy();
+
+#endif // __RECORD__
@@ -1,24 +1,27 @@
-/// Stage (source)
+/// Game renderer (source)
 /// (c) 2018 Jani Nykänen
 
-#include "stage.h"
+#include "render.h"
 
 #include "../engine/graphics.h"
 #include "../engine/sprite.h"
-#include "../lib/tmxc.h"
 
-#include "objects.h"
-#include "player.h"
-#include "status.h"
+#include "../sim/sim.h"
+#include "../sim/stage.h"
+#include "../sim/objects.h"
+#include "../sim/player.h"
+#include "../sim/boulder.h"
+#include "../sim/enemy.h"
+#include "../sim/key.h"
+#include "../sim/lock.h"
+#include "../sim/coin.h"
+#include "../sim/star.h"
 
-#include "../global.h"
+#include "hud.h"
 
 #include "math.h"
 #include "stdlib.h"
 
-// Default map size in tiles
-#define DEFAULT_MAP_SIZE 16*12
-
 // Bitmaps
 static BITMAP* bmpSky;
 static BITMAP* bmpSky3;
@@ -26,13 +29,13 @@ static BITMAP* bmpClouds;
 static BITMAP* bmpClouds2;
 static BITMAP* bmpTiles;
 static BITMAP* bmpElectricity;
-
-// Map
-static TILEMAP* mapMain;
-// Collision map
-static int colMap[DEFAULT_MAP_SIZE];
-// Layer data
-static int layerData[DEFAULT_MAP_SIZE];
+static BITMAP* bmpPlayer;
+static BITMAP* bmpBoulder;
+static BITMAP* bmpEnemy;
+static BITMAP* bmpKey;
+static BITMAP* bmpLock;
+static BITMAP* bmpCoin;
+static BITMAP* bmpStar;
 
 // Cloud position
 static float cloudPos;
@@ -41,19 +44,18 @@ static float lavaPos;
 // Shake timer
 static float shakeTimer;
 
-// Is electricity on
-static bool elecOn;
 // Electricity sprite
 static SPRITE sprElec;
 
+// Context being drawn
+static GAME_CONTEXT* view;
+
 
 // Is the tile in (x+dx,y+dy) same as in (x,y)
 static bool is_same_tile(TILEMAP* t, int id, int x, int y, int dx, int dy)
 {
-    if(x+dx < 0 || y +dy < 0 || x+dx >= t->width || y+dy >= t->height)
-        return true;
-
-    return id == layerData[(y+dy)*t->width + x + dx];
+    int tile = stage_get_tile(view,x+dx,y+dy);
+    return tile < 0 || id == tile;
 }
 
 
@@ -344,7 +346,7 @@ static void draw_map(TILEMAP* t)
     {
         for(x=0; x < t->width; ++ x)
         {
-            id = layerData[y*t->width + x];
+            id = stage_get_tile(view,x,y);
             if(id != 3 && id != 20) continue;
             draw_lava(t, x,y, id == 3 ? 0 : 1);
         }
@@ -355,7 +357,7 @@ static void draw_map(TILEMAP* t)
     {
         for(x=0; x < t->width; ++ x)
         {
-            id = layerData[y*t->width + x];
+            id = stage_get_tile(view,x,y);
             if(id == 0) continue;
 
             // TODO: Add 'switch'
@@ -393,11 +395,11 @@ static void draw_map(TILEMAP* t)
             }
             else if(id == 22 || id == 23)
             {
-                draw_electricity(t,x,y,id == 23,elecOn);
+                draw_electricity(t,x,y,id == 23,stage_is_electricity_on(view));
             }
             else if(id == 24 || id == 25)
             {
-                draw_electricity(t,x,y,id == 25,!elecOn);
+                draw_electricity(t,x,y,id == 25,!stage_is_electricity_on(view));
             }
         }
     }
@@ -407,8 +409,8 @@ static void draw_map(TILEMAP* t)
 // Draw stage background
 static void draw_background()
 {
-    BITMAP* bsky = status_get_if_final() ? bmpSky3 : bmpSky;
-    BITMAP* bclouds = status_get_if_final() ? bmpClouds2 : bmpClouds;
+    BITMAP* bsky = hud_get_if_final() ? bmpSky3 : bmpSky;
+    BITMAP* bclouds = hud_get_if_final() ? bmpClouds2 : bmpClouds;
 
     int i = 0;
 
@@ -420,58 +422,89 @@ static void draw_background()
 }
 
 
-// Parse map and create objects and define collision map
-static void parse_map(TILEMAP* t, bool colOnly)
+// Draw player
+static void draw_player(PLAYER* pl)
 {
-    int x = 0;
-    int y = 0;
-    int id = 0;
+    spr_draw(&pl->spr,bmpPlayer,(int)round(pl->vpos.x) - 4,(int)round(pl->vpos.y) -4 + 1,pl->dir);
+}
 
-    // Draw only lava
-    for(y=0; y < t->height; ++ y)
+
+// Draw boulder
+static void draw_boulder(BOULDER* b)
+{
+    if(b->exist == false) return;
+
+    spr_draw(&b->spr,bmpBoulder,(int)round(b->vpos.x),(int)round(b->vpos.y) +1,0);
+}
+
+
+// Draw enemy
+static void draw_enemy(ENEMY* e)
+{
+    if(e->exist == false) return;
+
+    spr_draw(&e->spr,bmpEnemy,e->vpos.x-4,e->vpos.y-4 +1,e->sprDir);
+}
+
+
+// Draw key
+static void draw_key(KEY* k)
+{
+    if(!k->exist) return;
+
+    spr_draw(&k->spr,bmpKey,
+        (int)round(k->vpos.x),(int)round(k->vpos.y + sin(k->floatTimer)),0);
+}
+
+
+// Draw lock
+static void draw_lock(LOCK* lock)
+{
+    if(lock->exist == false) return;
+
+    if(lock->opening)
     {
-        for(x=0; x < t->width; ++ x)
-        {
-            id = layerData[y*t->width + x];
-            if( ( (id >= 6  && id < 16) || id == 19 || id == 26) && !colOnly)
-            {
-                obj_add(id,x,y);
-            }
-            else if(id > 0)
-            {
-                colMap[y*t->width + x] = id;
-            }
-        }
+        spr_draw(&lock->spr,bmpLock,lock->vpos.x,lock->vpos.y,0);
     }
 }
 
 
-// Reset stage
-void stage_reset(bool soft)
+// Draw coin
+static void draw_coin(COIN* c)
 {
-    // Set variables to their default values
-    cloudPos = 0.0f;
-    lavaPos = 0.0f;
-    shakeTimer = 0.0f;
-    elecOn = true;
+    if(!c->exist) return;
 
-    if(mapMain == NULL) return;
+    spr_draw(&c->spr,bmpCoin,
+        (int)round(c->vpos.x),(int)round(c->vpos.y + sin(c->floatTimer)),0);
+}
 
-    // Clear collision map & copy layer data
-    int i = 0;
-    for(; i < mapMain->width*mapMain->height; ++ i)
+
+// Draw star
+static void draw_star(STAR* s)
+{
+    spr_draw(&s->spr,bmpStar,
+        (int)round(s->vpos.x),(int)round(s->vpos.y + cos(s->floatTimer)),0);
+}
+
+
+// Draw an object by its type
+static void draw_object(OBJECT* o)
+{
+    switch(o->type)
     {
-        layerData[i] = mapMain->layers[0] [i];
-        colMap[i] = 0;
+    case OBJ_BOULDER: draw_boulder((BOULDER*)o); break;
+    case OBJ_ENEMY: draw_enemy((ENEMY*)o); break;
+    case OBJ_KEY: draw_key((KEY*)o); break;
+    case OBJ_LOCK: draw_lock((LOCK*)o); break;
+    case OBJ_COIN: draw_coin((COIN*)o); break;
+    case OBJ_STAR: draw_star((STAR*)o); break;
+    default: break;
     }
-
-    // Create objects
-    parse_map(mapMain,soft);
 }
 
 
-// Initialize stage
-void stage_init(ASSET_PACK* ass)
+// Initialize renderer
+void render_init(ASSET_PACK* ass)
 {
     // Get assets
     bmpSky = (BITMAP*)get_asset(ass,"sky1");
@@ -480,18 +513,32 @@ void stage_init(ASSET_PACK* ass)
     bmpClouds2 = (BITMAP*)get_asset(ass,"clouds2");
     bmpTiles = (BITMAP*)get_asset(ass,"tiles1");
     bmpElectricity = (BITMAP*)get_asset(ass,"electricity");
+    bmpPlayer = (BITMAP*)get_asset(ass,"player");
+    bmpBoulder = (BITMAP*)get_asset(ass,"boulder");
+    bmpEnemy = (BITMAP*)get_asset(ass,"enemy");
+    bmpKey = (BITMAP*)get_asset(ass,"key");
+    bmpLock = (BITMAP*)get_asset(ass,"lock");
+    bmpCoin = (BITMAP*)get_asset(ass,"coin");
+    bmpStar = (BITMAP*)get_asset(ass,"star");
 
     // Create components
     sprElec = create_sprite(16,16);
 
-    mapMain = NULL;
-    // Reset values
-    stage_reset(true);
+    render_reset();
+}
+
+
+// Reset renderer
+void render_reset()
+{
+    cloudPos = 0.0f;
+    lavaPos = 0.0f;
+    shakeTimer = 0.0f;
 }
 
 
-// Update stage
-void stage_update(float tm)
+// Update renderer
+void render_update(float tm)
 {
     const float CLOUD_SPEED = 0.5f;
     const float LAVA_SPEED = 0.125f;
@@ -521,9 +568,11 @@ void stage_update(float tm)
 }
 
 
-// Draw stage
-void stage_draw()
+// Draw stage & objects
+void render_draw(GAME_CONTEXT* ctx)
 {
+    view = ctx;
+
     if(shakeTimer > 0.0f)
     {
         int shakex = rand() % 7 - 3;
@@ -537,207 +586,30 @@ void stage_draw()
     }
 
     draw_background();
-    draw_map(mapMain);
+    draw_map(stage_get_map(ctx));
 
     translate(0,0);
-}
-
-
-// Player electricity collision
-void stage_player_elec_collision(void* p)
-{
-    
-    int x = 0;
-    int y = 0;
-
-    PLAYER* pl = (PLAYER*)p;
 
-    int id;
-
-    for(; y < mapMain->height; ++ y)
+    // Draw game objects, type by type
+    OBJECT_POOL* p;
+    int t = 0;
+    int i;
+    for(; t < OBJ_TYPE_COUNT; ++ t)
     {
-        for(x = 0; x < mapMain->width; ++ x)
+        p = obj_get_pool(ctx,t);
+        for(i = 0; i < p->count; ++ i)
         {
-            id = layerData[y*mapMain->width + x];
-            bool cond1 = (id == 22 && elecOn) || (id == 24 && !elecOn );
-            bool cond2 = (id == 23 && elecOn) || (id == 25 && !elecOn );
-            if(!cond1 && !cond2)
-                continue;
-
-            if(cond1)
-            {
-                if(pl->jumping && (!stage_is_harmful(pl->oldPos.x,pl->oldPos.y) && pl->y == y && (  (pl->x == x-1 && pl->oldPos.x == x+1) ||
-                    (pl->x == x+1 && pl->oldPos.x == x-1) ) ) )
-                {
-                    pl_hurt(pl);
-                }
-            }
-
-            if(cond2)
-            {
-                
-                if(pl->falling && pl->x == x && pl->vpos.y > y*16.0f && pl->vpos.y < y*16.0f+16.0f)
-                {
-                    
-                    pl_hurt(pl);
-                }
-            }
+            draw_object(obj_pool_get(p,i));
         }
     }
-}
 
-
-// Get collision map
-int* stage_get_collision_map()
-{
-    return colMap;
-}
-
-
-// Get current map dimensions
-POINT stage_get_map_size()
-{
-    return point(mapMain->width,mapMain->height);
-}
-
-
-// Is the tile in x,y solid
-bool stage_is_solid(int x, int y)
-{
-    if(x < 0 || y < 0 || x >= mapMain->width || y >= mapMain->height)
-        return true;
-
-    int id = colMap[y * mapMain->width + x];
-
-    return (id == 1 || (id >= 4 && id <= 6) || id == 17 || id == 21);
-}
-
-
-// Is the tile in x,y vine
-bool stage_is_vine(int x, int y)
-{
-    if(x < 0 || y < 0 || x >= mapMain->width || y >= mapMain->height)
-        return false;
-
-    return layerData [y * mapMain->width + x] == 2;
-}
-
-
-// Set collision tile value
-void stage_set_collision_tile(int x, int y, int id)
-{
-    if(x < 0 || y < 0 || x >= mapMain->width || y >= mapMain->height)
-        return;
-
-    colMap[y * mapMain->width + x] = id;
-}
-
-
-// Set tile
-void stage_set_tile(int x, int y, int id)
-{
-    layerData [y*mapMain->width + x] = id;
-}
-
-
-// Is lava
-bool stage_is_lava(int x, int y)
-{
-    if(x < 0 || y < 0 || x >= mapMain->width || y >= mapMain->height)
-        return false;
-
-    int id = layerData[y * mapMain->width + x];
-    return id == 3 || id == 20;
+    // Draw player
+    draw_player(obj_get_player(ctx));
 }
 
 
-// Is harmful
-int stage_is_harmful(int x, int y)
-{
-    if(x < 0 || y < 0 || x >= mapMain->width || y >= mapMain->height)
-        return false;
-
-    int id = layerData[y * mapMain->width + x];
-    int idy = colMap[ (y+1) * mapMain->width + x];
-    if (id == 3 || idy == 4 || id == 20 || (elecOn && (id == 22 || id == 23))
-        || (!elecOn && (id == 24 || id == 25)))
-    {
-        return idy == 4 ? 1 : 2;   
-    }
-    return 0;
-}
-
-
-// Set shake timer value
-void stage_set_shake_timer(float s)
+// Set shake timer
+void render_shake(float s)
 {
     shakeTimer = s;
 }
-
-
-// Set stage name
-void stage_set_main_stage(const char* name)
-{
-    ASSET_PACK* ass = get_global_assets();
-    mapMain = (TILEMAP*)get_asset(ass,name);
-}
-
-
-/// Toggle purple blocks
-void stage_toggle_purple_blocks()
-{
-    int i = 0;
-    int id = 0;
-    for(; i < mapMain->width*mapMain->height; ++ i)
-    {
-        id = layerData[i];
-        if(id == 18)
-        {
-            layerData[i] = 17;
-            colMap[i] = 1;
-        }
-        else if(id == 17)
-        {
-            layerData[i] = 18;
-            colMap[i] = 0;
-        }
-        else if(id == 20)
-        {
-            layerData[i] = 21;
-            colMap[i] = 1;
-        }
-        else if(id == 21)
-        {
-            layerData[i] = 20;
-            colMap[i] = 0;
-        }
-    }
-}
-
-
-// Toggle electricity
-void stage_toggle_electricity()
-{
-    elecOn = !elecOn;
-}
-
-
-// Mutate the stage
-void stage_mutate()
-{
-    int i = 0;
-    int id = 0;
-    for(; i < mapMain->width*mapMain->height; ++ i)
-    {
-        id = layerData[i];
-        switch(id)
-        {
-        case 1: layerData[i] = 5; break;
-        case 5: layerData[i] = 17; break;
-        case 18: layerData[i] = 1; colMap[i] = 1; break;
-        case 2: layerData[i] = 22; break;
-        case 22: layerData[i] = 2; break;
-        default: break;
-        }
-    }
-}
\ No newline at end of file
@@ -0,0 +1,30 @@
+/// Game renderer (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __RENDER__
+#define __RENDER__
+
+#include "../engine/assets.h"
+
+#include "../sim/obase.h"
+
+/// Initialize renderer
+/// < ass Asset pack
+void render_init(ASSET_PACK* ass);
+
+/// Reset renderer
+void render_reset();
+
+/// Update background & tile animations
+/// < tm Time mul.
+void render_update(float tm);
+
+/// Draw the stage & the objects
+/// < ctx Game context
+void render_draw(GAME_CONTEXT* ctx);
+
+/// Set shake timer
+/// < s Shake value
+void render_shake(float s);
+
+#endif // __RENDER__
@@ -11,6 +11,9 @@
 #include "engine/assets.h"
 #include "engine/music.h"
 #include "engine/app.h"
+#include "engine/hotreload.h"
+
+#include "game/game.h"
 
 #include "vpad.h"
 #include "transition.h"
@@ -35,6 +38,9 @@ static void read_keyconfig(const char* path)
         vpad_add_button(1,(int)SDL_SCANCODE_RETURN,7);
         vpad_add_button(2,(int)SDL_SCANCODE_R,3);
         vpad_add_button(3,(int)SDL_SCANCODE_ESCAPE,6);
+        vpad_add_button(4,(int)SDL_SCANCODE_Z,4);
+        vpad_add_button(5,(int)SDL_SCANCODE_Y,5);
+        return;
     }
 
     int i = 0;
@@ -45,6 +51,8 @@ static void read_keyconfig(const char* path)
             (int)strtol(get_word(wd,i +1),NULL,10),
             (int)strtol(get_word(wd,i +2),NULL,10));
     }
+
+    destroy_word_data(wd);
 }
 
 
@@ -65,6 +73,13 @@ static int global_init()
     // Initialize global components
     trn_init(globalAssets);
 
+    // Watch the stages & bitmaps for changes
+    if(hotreload_init(globalAssets,game_on_asset_reload) == 0)
+    {
+        hotreload_watch("assets/maps");
+        hotreload_watch("assets/bitmaps");
+    }
+
     // Load save data
     if(read_save_data("save.dat") == 1)
     {
@@ -83,6 +98,7 @@ static void global_update(float tm)
 {
     vpad_update();
     trn_update(tm);
+    hotreload_poll();
 }
 
 
@@ -101,6 +117,8 @@ static void global_destroy()
 
     // Save settings
     save_settings("settings.dat");
+
+    hotreload_destroy();
 }
 
 
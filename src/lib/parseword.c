@@ -1,274 +1,188 @@
 /**
  * libparseword library
  * Source file
- * 
+ *
  * @author Jani Nykänen
  * @version 1.0.0
  */
 
 #include "parseword.h"
 
-#include "SDL2/SDL.h"
-
 #include "stdio.h"
 #include "stdlib.h"
 #include "stdbool.h"
 #include "string.h"
 
-// File size in bytes
-static int fileSize;
-// File data (char array)
-static char* fdata;
-
-// To avoid memory overflows etc
-static const int SAVE_BYTES = 1024;
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-// Calculate file size
-static int calculate_file_size(FILE* f)
+// Is the character a word delimiter
+static bool is_delimiter(char c)
 {
-    int length = 0;
-
-    char c;
-    while ((c = fgetc(f)) != EOF)
-        ++ length;
-
-    return length;
+    return c == ' ' || c == '\t' || c == ',' || c == '\n' || c == '\r';
 }
 
-// Store byte data to a char array
-static int store_byte_data(FILE* f)
+// Is the character a delimiter, a quote or a comment start
+static bool is_special(char c)
 {
+    return is_delimiter(c) || c == '#' || c == '"' || c == 39;
+}
 
-    rewind(f);
-
-    // Allocate memory
-    fdata = (char*)malloc((size_t)fileSize + SAVE_BYTES);
-    if(fdata == NULL)
-    {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
-        return 1;
-    }
-
-    // Store characters
-    char c;
-    int index = 0;
-    while ((c = fgetc(f)) != EOF)
+// Find the first special character, returns end if not found
+static char* find_special(char* s, char* end)
+{
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i dquote = _mm_set1_epi8('"');
+    const __m128i squote = _mm_set1_epi8(39);
+
+    __m128i v, m;
+    int mask;
+    for(; end - s >= 16; s += 16)
     {
-        fdata[index] = c;
-        ++ index;
+        v = _mm_loadu_si128((const __m128i*)s);
+        m = _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v,space),_mm_cmpeq_epi8(v,tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(v,comma),_mm_cmpeq_epi8(v,nl))),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v,cr),_mm_cmpeq_epi8(v,hash)),
+                _mm_or_si128(_mm_cmpeq_epi8(v,dquote),_mm_cmpeq_epi8(v,squote))));
+
+        mask = _mm_movemask_epi8(m);
+        if(mask != 0)
+            return s + __builtin_ctz(mask);
     }
+#endif
 
-    return 0;
+    for(; s < end && !is_special(*s); ++ s);
+    return s;
 }
 
-//  Calculate actual size & word count and/or store word positions, length and actual data
-static void read_data(int* charCount, int* wordCount, int* wordPos, int* wordLengths, char* data)
+// Store a word view and terminate the word in place
+static void add_word(WORDDATA* w, char* start, char* wend)
 {
-    int size = 0;
-    int words = 0;
+    if(wend <= start) return;
 
-    char c;
-    int index = 0;
+    w->wordPos[w->wordCount] = (int)(start - w->data);
+    w->wordLength[w->wordCount] = (int)(wend - start);
+    ++ w->wordCount;
 
-    bool commentStarted = false;
-    bool quote = false;
-    char quoteType = 0;
-    int wordLength = 0;
-    bool wordStarted = false;
+    *wend = 0;
+}
 
-    int cindex = 0;
-    int wstart = 0;
+// Split the data to words in one pass
+static void read_words(WORDDATA* w)
+{
+    char* s = w->data;
+    char* end = w->data + w->size;
+    char* start;
+    char* q;
+    char quoteType;
 
-    for(; index < fileSize; ++ index)
+    while(s < end)
     {
-        c = fdata[index];
-        
-        if(!commentStarted && c == '#')
+        // Skip delimiters
+        if(is_delimiter(*s))
         {
-            commentStarted = true;
-        }
-        else if(!commentStarted && !quote && (c == 39 || c == '"'))
-        {
-            quote = true;
-            quoteType = c;
-            wordStarted = true;
-            wordLength = 0;
-            wstart = cindex;
+            ++ s;
             continue;
         }
 
-        if(commentStarted)
+        // Comment, skip to the end of the line
+        if(*s == '#')
         {
-            if(c == '\n')
-                commentStarted = false;
-            
+            s = (char*)memchr(s,'\n',end-s);
+            if(s == NULL) break;
             continue;
         }
 
-        if(quote)
-        {
-            if(c == quoteType)
-            {
-                quote = false;
-                wordStarted = false;
-
-                if(wordPos != NULL)
-                {
-                    wordPos[words] = wstart;
-                }
-
-                if(wordLength > 0)
-                    ++ words;
-
-                if(data != NULL)
-                {
-                    data[cindex] = 0;
-                    ++ cindex;
-                }
-
-                continue;
-            }
-
-            if(c != '\n')
-            {
-                if(data != NULL)
-                {
-                    data[cindex] = c;
-                }
-                ++ size;
-                ++ cindex;
-            }
-
-            ++ wordLength;
-        }
-        else 
+        // Quoted word
+        if(*s == '"' || *s == 39)
         {
-            if(c != ' ' && c != '\t' && c != ',' && c != '\n')
-            {
-                if(data != NULL)
-                {
-                    data[cindex] = c;
-                }
-
-                ++ size;
-                ++ wordLength;
-                if(!wordStarted)
-                {
-                    if(wordPos != NULL)
-                    {
-                        wordPos[words] = cindex;
-                    }
-
-                    wordStarted = true;
-                    ++ words;
-                }
-                ++ cindex;
-            }
-            else
-            {
-                if(wordStarted && wordLength > 0)
-                {
-                    if(wordLengths != NULL)
-                        wordLengths[words-1] = wordLength;
-
-                    if(data != NULL)
-                    {
-                        data[cindex] = 0;
-                        ++ cindex;
-                    }
-                }
-                wordStarted = false;
-                wordLength = 0;
-            }
+            quoteType = *s;
+            start = ++ s;
+            q = (char*)memchr(s,quoteType,end-s);
+            s = q == NULL ? end : q;
+            add_word(w,start,s);
+            ++ s;
+            continue;
         }
-        
-    }
-
-    if(quote)
-    {
-        quote = false;
-        wordStarted = false;
 
-        if(wordPos != NULL)
+        // Normal word
+        start = s;
+        s = find_special(s +1,end);
+        while(s < end && (*s == '"' || *s == 39))
         {
-            wordPos[words] = wstart;
+            s = find_special(s +1,end);
         }
 
-        if(wordLength > 0)
-            ++ words;
-
-        if(data != NULL)
+        // A comment may start right after a word
+        quoteType = s < end ? *s : 0;
+        add_word(w,start,s);
+        if(quoteType == '#')
         {
-            data[cindex] = 0;
-            ++ cindex;
+            s = (char*)memchr(s,'\n',end-s);
+            if(s == NULL) break;
+            continue;
         }
+        ++ s;
     }
-
-    if(charCount != NULL) *charCount = size;
-    if(wordCount != NULL) *wordCount = words;
 }
 
 // Parse file
 WORDDATA* parse_file(const char* path)
 {
     // Open file
-    FILE* f = fopen(path,"r");
+    FILE* f = fopen(path,"rb");
     if(f == NULL)
     {
-        char err[256];
-        snprintf(err,256,"Failed to open a file in %s!\n",path);
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
+        printf("Failed to open a file in %s!\n",path);
         return NULL;
     }
-    // Calculate char count & store data
-    fileSize = calculate_file_size(f);
-    if(store_byte_data(f) == 1)
-    {
-        fclose(f);
-        return NULL;
-    }
-    fclose(f);
 
-    // Allocate memory
-    WORDDATA* w = malloc(sizeof(WORDDATA));
+    // Get file size
+    fseek(f,0,SEEK_END);
+    long fsize = ftell(f);
+    fseek(f,0,SEEK_SET);
+    if(fsize < 0) fsize = 0;
+
+    // Every word takes at least two bytes (one character and a delimiter),
+    // so the views can be allocated in the same block as the data
+    int maxWords = (int)fsize/2 + 1;
+    size_t viewBytes = sizeof(int) * maxWords;
+    WORDDATA* w = (WORDDATA*)malloc(sizeof(WORDDATA) + viewBytes*2 + fsize + 1);
     if(w == NULL)
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
-        return NULL;
-    }
-
-    // Calculate actual size
-    read_data(&w->size,&w->wordCount,NULL,NULL,NULL);
-    // Allocate memory for the data
-    w->data = (char*)malloc(sizeof(char) * (w->size + w->wordCount) + SAVE_BYTES );
-    if(w->data == NULL)
-    {
-        free(w);
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
-        return NULL;
-    }
-    w->wordPos = (int*)malloc(w->wordCount * sizeof(int));
-    if(w->data == NULL)
-    {
-        free(w->data);
-        free(w);
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
+        printf("Memory allocation error!\n");
+        fclose(f);
         return NULL;
     }
-    w->wordLength = (int*)malloc(w->wordCount * sizeof(int));
-    if(w->wordLength == NULL)
+    w->wordPos = (int*)(w + 1);
+    w->wordLength = w->wordPos + maxWords;
+    w->data = (char*)(w->wordLength + maxWords);
+    w->size = (int)fsize;
+    w->wordCount = 0;
+
+    // Read everything at once
+    if(fsize > 0 && fread(w->data,1,fsize,f) != (size_t)fsize)
     {
-        free(w->data);
-        free(w->wordPos);
+        printf("Failed to read a file in %s!\n",path);
         free(w);
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!\n",NULL);
+        fclose(f);
         return NULL;
     }
-    // Store word pos & length
-    read_data(NULL,NULL,w->wordPos,w->wordLength,w->data);
-    w->data[w->size + w->wordCount] = 0;
+    fclose(f);
+    w->data[w->size] = 0;
 
-    free(fdata);
+    // Find words
+    read_words(w);
 
     return w;
 }
@@ -287,4 +201,4 @@ char* get_word(WORDDATA* w, int index)
     if(index >= w->wordCount) return NULL;
 
     return w->data + w->wordPos[index];
-}
\ No newline at end of file
+}
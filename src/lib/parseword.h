@@ -9,7 +9,11 @@
 #ifndef __LIB__PARSEWORD__
 #define __LIB__PARSEWORD__
 
-/** Word data type */
+/** 
+ * Word data type. Words are views (offset & length) to the
+ * file content, terminated in place. Everything lives in
+ * a single memory block.
+ */
 typedef struct
 {
     char* data;
@@ -1,297 +1,627 @@
+/// Simple TMX file loader for C (source)
+/// (c) 2018 Jani Nykänen
 
 #include "tmxc.h"
 
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
-#include "malloc.h"
+#include "stdbool.h"
 
-#include "SDL2/SDL.h"
+/// Maximum amount of attributes read from a single tag
+#define MAX_ATTRIBUTES 16
 
-/// File length
-static int file_length;
-/// Content as string
-static char* file_content;
+/// Attribute, points to the file content
+typedef struct
+{
+    const char* name;
+    int nameLen;
+    const char* value;
+    int valueLen;
+}
+ATTRIBUTE;
 
-/// Calculate length of the file
-/// < f File
-static void calculate_length(FILE* f)
+/// Tag, points to the file content
+typedef struct
 {
-    int len = 0;
-    char c;
-    while ((c = fgetc(f)) != EOF) 
-    {
-        len ++;
-    }
-    rewind(f);
-    file_length = len;
+    const char* name;
+    int nameLen;
+    bool closing;
+    bool selfClosing;
+    ATTRIBUTE attr[MAX_ATTRIBUTES];
+    int attrCount;
 }
+TAG;
 
-/// Create content
-/// < f File
-/// > 0 on success, 1 otherwise
-static int create_content(FILE* f)
+/// Parser state
+typedef struct
 {
-    // Allocate memory for the file content
-    file_content = (char*)malloc(file_length * sizeof(char));
-    if(file_content == NULL)
-    {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!",NULL);
-        return 1;
-    }
+    /// Current position
+    const char* p;
+    /// End of the content
+    const char* end;
+    /// Target map
+    TILEMAP* t;
+
+    /// Allocated slots
+    int layerCap;
+    int objectCap;
+    int propertyCap;
+
+    /// Current tile layer, -1 if none
+    int curLayer;
+    /// Current property owner
+    int owner;
+    int ownerIndex;
+    /// Is inside a tileset (tileset properties are ignored)
+    bool inTileset;
+}
+PARSER;
+
+
+/// Is white space
+/// < c Character
+/// > True or false
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
 
-    // Store characters
-    int p = 0;
-    char c;
-    while ((c = fgetc(f)) != EOF) 
+/// Does a non-terminated string equal to a literal
+/// < s String
+/// < len String length
+/// < lit Literal
+/// > True or false
+static bool str_equals(const char* s, int len, const char* lit)
+{
+    return (int)strlen(lit) == len && strncmp(s,lit,len) == 0;
+}
+
+/// Grow an array if it is full
+/// < arr Array
+/// < cap Capacity
+/// < count Element count
+/// < elemSize Element size
+/// > 0 on success, 1 on error
+static int grow(void** arr, int* cap, int count, size_t elemSize)
+{
+    if(count < *cap) return 0;
+
+    int ncap = *cap == 0 ? 8 : *cap * 2;
+    void* narr = realloc(*arr, elemSize * ncap);
+    if(narr == NULL)
     {
-        file_content[p] = c;
-        p ++;
+        printf("Memory allocation error!\n");
+        return 1;
     }
-    rewind(f);
+    *arr = narr;
+    *cap = ncap;
 
     return 0;
 }
 
-/// Get layer count
-/// > Layer count
-static int get_layer_count()
+/// Parse a decimal number (hand-rolled, no temporaries)
+/// < s String
+/// < len String length
+/// > Value
+static float parse_number(const char* s, int len)
 {
-    // These WLEN things are actually quite useless
-    const int WLEN = 3;
-    int count = 0;
-
-    char * s = file_content;
-
     int i = 0;
-    for(; i < file_length - WLEN; i++)
+    float sign = 1.0f;
+    float v = 0.0f;
+    float frac = 0.1f;
+
+    if(len > 0 && s[0] == '-')
+    {
+        sign = -1.0f;
+        ++ i;
+    }
+    for(; i < len && s[i] >= '0' && s[i] <= '9'; ++ i)
+    {
+        v = v * 10.0f + (float)(s[i] - '0');
+    }
+    if(i < len && s[i] == '.')
     {
-        if(
-            s[i] == '/' && s[i+1] == 'l' && s[i+2] == 'a'
-        )
+        for(++ i; i < len && s[i] >= '0' && s[i] <= '9'; ++ i)
         {
-            count ++;
+            v += frac * (float)(s[i] - '0');
+            frac *= 0.1f;
         }
     }
 
-    return count;
+    return sign * v;
 }
 
-/// Get numeric value between " "
-/// < start Start pos
-static int get_value(int start)
+/// Find an attribute
+/// < tag Tag
+/// < name Attribute name
+/// > Attribute, NULL if not found
+static const ATTRIBUTE* find_attr(const TAG* tag, const char* name)
 {
-    char num[8];
-    int n = 0;
-    for(; n < 8; n++) num[n] = '\0';
-    int i = start;
-    int p = 0;
-    for(; i < file_length && file_content[i] != '"'; i++)
+    int i = 0;
+    for(; i < tag->attrCount; ++ i)
     {
-        num[p] = file_content[i];
-        p ++;
+        if(str_equals(tag->attr[i].name,tag->attr[i].nameLen,name))
+            return &tag->attr[i];
     }
-    return strtol(num,NULL,10);
+    return NULL;
 }
 
-/// Get tilemap dimensions, in tiles
-/// < w Where width is stored
-/// < h Where height is stored
-static void get_dimensions(int* w, int* h)
+/// Get a numeric attribute value
+/// < tag Tag
+/// < name Attribute name
+/// < def Default value
+/// > Value
+static float attr_number(const TAG* tag, const char* name, float def)
 {
-    const int WLEN = 3;
-    int count = 0;
+    const ATTRIBUTE* a = find_attr(tag,name);
+    return a == NULL ? def : parse_number(a->value,a->valueLen);
+}
 
-    char * s = file_content;
+/// Copy a string attribute value
+/// < tag Tag
+/// < name Attribute name
+/// < out Output buffer
+/// < size Buffer size
+static void attr_string(const TAG* tag, const char* name, char* out, int size)
+{
+    const ATTRIBUTE* a = find_attr(tag,name);
+    int len = a == NULL ? 0 : a->valueLen;
+    if(len >= size) len = size-1;
 
-    int i = 0;
-    for(; i < file_length - WLEN; i++)
+    if(len > 0)
+        memcpy(out,a->value,len);
+    out[len] = 0;
+}
+
+/// Read a tag starting from the current position ('<')
+/// < ps Parser
+/// < tag Where the tag is stored
+/// > 0 on success, 1 on error
+static int read_tag(PARSER* ps, TAG* tag)
+{
+    const char* s = ps->p + 1;
+    const char* end = ps->end;
+
+    tag->nameLen = 0;
+    tag->attrCount = 0;
+    tag->closing = false;
+    tag->selfClosing = false;
+
+    if(s >= end) return 1;
+
+    // Skip declarations & comments
+    if(*s == '?' || *s == '!')
     {
-        if(
-         (count == 0 && ( s[i] == 't' && s[i+1] == 'h' && s[i+2] == '='))
-        ||
-         ( s[i] == 'h' && s[i+1] == 't' && s[i+2] == '=')
-        )
+        if(end - s >= 3 && s[1] == '-' && s[2] == '-')
         {
-            if(count == 1)
-            {
-                *h = get_value(i+4);
-                break;
-            }
-            else
-            {
-                *w = get_value(i+4);
-            }
-            count ++;
+            for(s += 3; s + 2 < end && !(s[0] == '-' && s[1] == '-' && s[2] == '>'); ++ s);
+            ps->p = s + 3 < end ? s + 3 : end;
+        }
+        else
+        {
+            s = (const char*)memchr(s,'>',end-s);
+            ps->p = s == NULL ? end : s + 1;
         }
+        return 0;
     }
 
-}
-
-/// Get tile dimensions
-/// TODO: Repeating code, replace with something better
-/// < w Where width is stored
-/// < h Where height is stored
-static void get_tile_dimensions(int* w, int* h)
-{
-    const int WLEN = 3;
-    int count = 0;
+    if(*s == '/')
+    {
+        tag->closing = true;
+        ++ s;
+    }
 
-    char * s = file_content;
+    // Name
+    tag->name = s;
+    while(s < end && !is_space(*s) && *s != '>' && *s != '/') ++ s;
+    tag->nameLen = (int)(s - tag->name);
 
-    int i = 0;
-    for(; i < file_length - WLEN; i++)
+    // Attributes
+    const char* n;
+    int nlen;
+    char quote;
+    for(;;)
     {
-        if(
-         (count == 0 && ( s[i] == 'e' && s[i+1] == 'w' && s[i+2] == 'i'))
-        ||
-         ( s[i] == 'e' && s[i+1] == 'h' && s[i+2] == 'e')
-        )
+        while(s < end && is_space(*s)) ++ s;
+        if(s >= end) return 1;
+
+        if(*s == '>')
         {
-            if(count == 1)
-            {
-                *h = get_value(i+9);
-                break;
-            }
-            else
-            {
-                *w = get_value(i+8);
-            }
-            count ++;
+            ++ s;
+            break;
         }
+        else if(*s == '/')
+        {
+            tag->selfClosing = true;
+            ++ s;
+            continue;
+        }
+
+        n = s;
+        while(s < end && *s != '=' && !is_space(*s) && *s != '>' && *s != '/') ++ s;
+        nlen = (int)(s - n);
+        while(s < end && is_space(*s)) ++ s;
+        if(s >= end) return 1;
+        if(*s != '=')
+        {
+            if(nlen == 0) ++ s;
+            continue;
+        }
+
+        ++ s;
+        while(s < end && is_space(*s)) ++ s;
+        if(s >= end || (*s != '"' && *s != '\'')) return 1;
+
+        quote = *(s ++);
+        const char* v = s;
+        s = (const char*)memchr(s,quote,end-s);
+        if(s == NULL) return 1;
+
+        if(tag->attrCount < MAX_ATTRIBUTES)
+        {
+            tag->attr[tag->attrCount ++] = (ATTRIBUTE){n,nlen,v,(int)(s - v)};
+        }
+        ++ s;
     }
 
+    ps->p = s;
+    return 0;
 }
 
-/// Parse CSV data to a layer data
+/// Parse CSV data straight to a layer
+/// < ps Parser
 /// < layer Layer
-/// < start Start position in the file content
-/// > End position
-static int parse_CSV(int* layer, int start)
+/// < count Layer size in tiles
+static void parse_CSV(PARSER* ps, LAYER layer, int count)
 {
-    char* s = file_content;
-    int i = start;
-    int p = 0;
-    char buf[10];
-    int bp = 0;
+    const char* s = ps->p;
+    const char* end = ps->end;
+    unsigned int v;
+    int i = 0;
 
-    for(; i < file_length && s[i] != '<'; i++)
+    while(s < end && *s != '<')
     {
-        if(s[i] != ',')
+        if(*s >= '0' && *s <= '9')
         {
-            if(s[i] != ' ' && s[i] != '\t' && s[i] != '\n')
+            v = 0;
+            do
             {
-                buf[bp] = s[i];
-                bp ++;
+                v = v * 10 + (unsigned int)(*s - '0');
+                ++ s;
             }
+            while(s < end && *s >= '0' && *s <= '9');
+
+            if(i < count)
+                layer[i] = (int)v;
+            ++ i;
         }
         else
         {
-            if(bp > 0)
-            {
-                buf[bp] = '\0';
-                
-                layer[p] = (int)strtol(buf,NULL,10);
-                p ++;
-            }
-            bp = 0;
+            ++ s;
         }
     }
-    layer[p] = (int)strtol(buf,NULL,10);
 
-    return i;
+    ps->p = s;
 }
 
-/// Parse layers
-/// < layers Layers
-static void parse_layers(LAYER* layers)
+/// Add a new tile layer
+/// < ps Parser
+/// < tag Layer tag
+/// > 0 on success, 1 on error
+static int add_layer(PARSER* ps, const TAG* tag)
 {
-    const int WLEN = 3;
-    int count = 0;
+    TILEMAP* t = ps->t;
 
-    char * s = file_content;
+    if(grow((void**)&t->layers,&ps->layerCap,t->layerCount,sizeof(LAYER)) != 0)
+        return 1;
 
-    int i = 0;
-    for(; i < file_length - WLEN; i++)
+    int w = (int)attr_number(tag,"width",(float)t->width);
+    int h = (int)attr_number(tag,"height",(float)t->height);
+    int size = w*h > t->width*t->height ? w*h : t->width*t->height;
+
+    LAYER l = (LAYER)calloc(size > 0 ? size : 1,sizeof(int));
+    if(l == NULL)
+    {
+        printf("Memory allocation error!\n");
+        return 1;
+    }
+    t->layers[t->layerCount] = l;
+    ps->curLayer = t->layerCount ++;
+
+    return 0;
+}
+
+/// Add a new object
+/// < ps Parser
+/// < tag Object tag
+/// > 0 on success, 1 on error
+static int add_object(PARSER* ps, const TAG* tag)
+{
+    TILEMAP* t = ps->t;
+
+    if(grow((void**)&t->objects,&ps->objectCap,t->objectCount,sizeof(TMX_OBJECT)) != 0)
+        return 1;
+
+    TMX_OBJECT* o = &t->objects[t->objectCount ++];
+    o->id = (int)attr_number(tag,"id",0.0f);
+    o->gid = (int)attr_number(tag,"gid",0.0f);
+    o->layer = t->objectLayerCount-1;
+    o->x = attr_number(tag,"x",0.0f);
+    o->y = attr_number(tag,"y",0.0f);
+    o->width = attr_number(tag,"width",0.0f);
+    o->height = attr_number(tag,"height",0.0f);
+    attr_string(tag,"name",o->name,TMX_NAME_SIZE);
+    attr_string(tag,"type",o->type,TMX_NAME_SIZE);
+
+    return 0;
+}
+
+/// Add a new property to the current owner
+/// < ps Parser
+/// < tag Property tag
+/// > 0 on success, 1 on error
+static int add_property(PARSER* ps, const TAG* tag)
+{
+    TILEMAP* t = ps->t;
+
+    if(grow((void**)&t->properties,&ps->propertyCap,t->propertyCount,sizeof(TMX_PROPERTY)) != 0)
+        return 1;
+
+    TMX_PROPERTY* p = &t->properties[t->propertyCount ++];
+    p->owner = ps->owner;
+    p->ownerIndex = ps->ownerIndex;
+    attr_string(tag,"name",p->name,TMX_NAME_SIZE);
+    attr_string(tag,"value",p->value,TMX_VALUE_SIZE);
+
+    return 0;
+}
+
+/// Handle an opening tag
+/// < ps Parser
+/// < tag Tag
+/// > 0 on success, 1 on error
+static int open_element(PARSER* ps, const TAG* tag)
+{
+    TILEMAP* t = ps->t;
+
+    if(str_equals(tag->name,tag->nameLen,"map"))
+    {
+        t->width = (int)attr_number(tag,"width",0.0f);
+        t->height = (int)attr_number(tag,"height",0.0f);
+        t->tileW = (int)attr_number(tag,"tilewidth",0.0f);
+        t->tileH = (int)attr_number(tag,"tileheight",0.0f);
+
+        ps->owner = TMX_OWNER_MAP;
+        ps->ownerIndex = 0;
+    }
+    else if(str_equals(tag->name,tag->nameLen,"tileset"))
     {
-        if( s[i] == 'v' && s[i+1] == '"' && s[i+2] == '>')
+        ps->inTileset = !tag->selfClosing;
+    }
+    else if(str_equals(tag->name,tag->nameLen,"layer"))
+    {
+        if(add_layer(ps,tag) != 0)
+            return 1;
+
+        if(!tag->selfClosing)
         {
-            i = parse_CSV(layers[count],i+3);
-            count ++;
+            ps->owner = TMX_OWNER_LAYER;
+            ps->ownerIndex = ps->curLayer;
         }
+        else
+        {
+            ps->curLayer = -1;
+        }
+    }
+    else if(str_equals(tag->name,tag->nameLen,"data"))
+    {
+        const ATTRIBUTE* enc = find_attr(tag,"encoding");
+        if(ps->curLayer < 0 || tag->selfClosing)
+            return 0;
+
+        if(enc == NULL || !str_equals(enc->value,enc->valueLen,"csv"))
+        {
+            printf("Unsupported layer encoding, only CSV is supported!\n");
+            return 0;
+        }
+        parse_CSV(ps,t->layers[ps->curLayer],t->width*t->height);
+    }
+    else if(str_equals(tag->name,tag->nameLen,"objectgroup"))
+    {
+        ++ t->objectLayerCount;
+        if(!tag->selfClosing)
+        {
+            ps->owner = TMX_OWNER_OBJECT_LAYER;
+            ps->ownerIndex = t->objectLayerCount-1;
+        }
+    }
+    else if(str_equals(tag->name,tag->nameLen,"object"))
+    {
+        if(add_object(ps,tag) != 0)
+            return 1;
+
+        if(!tag->selfClosing)
+        {
+            ps->owner = TMX_OWNER_OBJECT;
+            ps->ownerIndex = t->objectCount-1;
+        }
+    }
+    else if(str_equals(tag->name,tag->nameLen,"property") && !ps->inTileset)
+    {
+        return add_property(ps,tag);
     }
+
+    return 0;
 }
 
-/// Load a tilemap from a file
-TILEMAP* load_tilemap(const char* path)
+/// Handle a closing tag
+/// < ps Parser
+/// < tag Tag
+static void close_element(PARSER* ps, const TAG* tag)
 {
-    // Allocate memory for the map
-    TILEMAP* t = (TILEMAP*)malloc(sizeof(TILEMAP));
-    if(t == NULL)
+    if(str_equals(tag->name,tag->nameLen,"tileset"))
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!",NULL);
-        return NULL;
+        ps->inTileset = false;
     }
-    // Open file
-    FILE * f = fopen(path,"r");
-    if(f == NULL)
+    else if(str_equals(tag->name,tag->nameLen,"layer")
+        || str_equals(tag->name,tag->nameLen,"objectgroup"))
     {
-        char err[128];
-        snprintf(err,128,"Failed to load a tilemap in %s!",path);
+        ps->curLayer = -1;
+        ps->owner = TMX_OWNER_MAP;
+        ps->ownerIndex = 0;
+    }
+    else if(str_equals(tag->name,tag->nameLen,"object"))
+    {
+        ps->owner = TMX_OWNER_OBJECT_LAYER;
+        ps->ownerIndex = ps->t->objectLayerCount-1;
+    }
+}
 
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
+/// Parse a tilemap from a memory buffer
+TILEMAP* parse_tilemap(const char* data, int size)
+{
+    // Allocate memory for the map
+    TILEMAP* t = (TILEMAP*)calloc(1,sizeof(TILEMAP));
+    if(t == NULL)
+    {
+        printf("Memory allocation error!\n");
         return NULL;
     }
 
-    // Calculate length
-    calculate_length(f);
-    // Create content
-    if(create_content(f) != 0)
+    PARSER ps;
+    memset(&ps,0,sizeof(PARSER));
+    ps.p = data;
+    ps.end = data + size;
+    ps.t = t;
+    ps.curLayer = -1;
+    ps.owner = TMX_OWNER_MAP;
+
+    // Go through the tags in one sweep
+    TAG tag;
+    while(ps.p < ps.end)
     {
-        return NULL;
+        ps.p = (const char*)memchr(ps.p,'<',ps.end-ps.p);
+        if(ps.p == NULL)
+            break;
+
+        if(read_tag(&ps,&tag) != 0)
+        {
+            printf("Malformed TMX data!\n");
+            destroy_tilemap(t);
+            return NULL;
+        }
+        if(tag.nameLen == 0)
+            continue;
+
+        if(tag.closing)
+        {
+            close_element(&ps,&tag);
+        }
+        else if(open_element(&ps,&tag) != 0)
+        {
+            destroy_tilemap(t);
+            return NULL;
+        }
     }
-    // Close file
-    fclose(f);
 
-    // Count layers
-    t->layerCount = get_layer_count();
-   
-    // Get dimensions
-    get_dimensions(&t->width,&t->height);
-    get_tile_dimensions(&t->tileW,&t->tileH);
-   
     // Calculate size in pixels
     t->pwidth = t->width * t->tileW;
     t->pheight = t->height * t->tileH;
     // Set tile count
     t->tcount = t->width * t->height;
 
-    // Allocate memory for the layers
-    t->layers = (LAYER*)malloc(sizeof(LAYER) * t->layerCount);
-    if(t->layers == NULL)
+    return t;
+}
+
+/// Load a tilemap from a file
+TILEMAP* load_tilemap(const char* path)
+{
+    // Open file
+    FILE* f = fopen(path,"rb");
+    if(f == NULL)
     {
-        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!",NULL);
+        printf("Failed to load a tilemap in %s!\n",path);
         return NULL;
     }
+
+    // Read the whole content at once
+    fseek(f,0,SEEK_END);
+    long size = ftell(f);
+    fseek(f,0,SEEK_SET);
+
+    char* data = (char*)malloc(size > 0 ? size : 1);
+    if(data == NULL)
+    {
+        printf("Memory allocation error!\n");
+        fclose(f);
+        return NULL;
+    }
+    if(size <= 0 || fread(data,1,size,f) != (size_t)size)
+    {
+        printf("Failed to read a tilemap in %s!\n",path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    // Parse
+    TILEMAP* t = parse_tilemap(data,(int)size);
+    free(data);
+
+    return t;
+}
+
+/// Get a custom property value
+const char* tmx_get_property(TILEMAP* t, int owner, int index, const char* name)
+{
     int i = 0;
-    for(; i < t->layerCount; i++)
+    TMX_PROPERTY* p;
+    for(; i < t->propertyCount; ++ i)
     {
-        t->layers[i] = (LAYER)malloc(sizeof(int) * t->width * t->height);
-        if(t->layers[i] == NULL)
+        p = &t->properties[i];
+        if(p->owner == owner && (owner == TMX_OWNER_MAP || p->ownerIndex == index)
+            && strcmp(p->name,name) == 0)
         {
-            free(t->layers);
-            SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!","Memory allocation error!",NULL);
-            return NULL;
+            return p->value;
         }
     }
-    // Parse layers
-    parse_layers(t->layers);
+    return NULL;
+}
 
-    // Free memory & set globals to their default values
-    free(file_content);
-    file_length = 0;
+/// Extract spawn points from a tile layer
+int tmx_extract_spawns(TILEMAP* t, int layer, bool (*filter)(int))
+{
+    if(layer < 0 || layer >= t->layerCount) return 1;
 
-    return t;
+    LAYER l = t->layers[layer];
+    int count = 0;
+    int i = 0;
+    for(; i < t->tcount; ++ i)
+    {
+        if(filter(l[i])) ++ count;
+    }
+
+    free(t->spawns);
+    t->spawns = (TMX_SPAWN*)malloc(sizeof(TMX_SPAWN) * (count > 0 ? count : 1));
+    if(t->spawns == NULL)
+    {
+        printf("Memory allocation error!\n");
+        t->spawnCount = 0;
+        return 1;
+    }
+
+    t->spawnCount = 0;
+    for(i = 0; i < t->tcount; ++ i)
+    {
+        if(filter(l[i]))
+        {
+            t->spawns[t->spawnCount ++] = (TMX_SPAWN){l[i],i % t->width,i / t->width};
+        }
+    }
+
+    return 0;
 }
 
 /// Destroy a tilemap
@@ -305,5 +635,9 @@ void destroy_tilemap(TILEMAP* t)
     {
         free(t->layers[i]);
     }
+    free(t->layers);
+    free(t->objects);
+    free(t->properties);
+    free(t->spawns);
     free(t);
-}
\ No newline at end of file
+}
@@ -4,9 +4,69 @@
 #ifndef __TMXC__
 #define __TMXC__
 
+#include "stdbool.h"
+
+/// Name & type string size
+#define TMX_NAME_SIZE 32
+/// Property value string size
+#define TMX_VALUE_SIZE 64
+
+/// Property owner types
+enum
+{
+    TMX_OWNER_MAP = 0,
+    TMX_OWNER_LAYER = 1,
+    TMX_OWNER_OBJECT_LAYER = 2,
+    TMX_OWNER_OBJECT = 3,
+};
+
 /// Map layer
 typedef int* LAYER;
 
+/// Custom property
+typedef struct
+{
+    /// Owner type
+    int owner;
+    /// Owner index (layer, object layer or object)
+    int ownerIndex;
+    /// Property name
+    char name[TMX_NAME_SIZE];
+    /// Property value
+    char value[TMX_VALUE_SIZE];
+}
+TMX_PROPERTY;
+
+/// Object in an object layer
+typedef struct
+{
+    /// Object id
+    int id;
+    /// Global tile id (0 if none)
+    int gid;
+    /// Object layer index
+    int layer;
+    /// Position & size in pixels
+    float x;
+    float y;
+    float width;
+    float height;
+    /// Object name
+    char name[TMX_NAME_SIZE];
+    /// Object type
+    char type[TMX_NAME_SIZE];
+}
+TMX_OBJECT;
+
+/// Spawn point (a tile that creates an object)
+typedef struct
+{
+    int id;
+    int x;
+    int y;
+}
+TMX_SPAWN;
+
 /// Tilemap type
 typedef struct
 {
@@ -28,6 +88,23 @@ typedef struct
     int pheight;
     /// Tile count
     int tcount;
+
+    /// Objects (from all the object layers)
+    TMX_OBJECT* objects;
+    /// Object count
+    int objectCount;
+    /// Object layer count
+    int objectLayerCount;
+
+    /// Custom properties
+    TMX_PROPERTY* properties;
+    /// Property count
+    int propertyCount;
+
+    /// Spawn points, NULL if not extracted
+    TMX_SPAWN* spawns;
+    /// Spawn point count
+    int spawnCount;
 }
 TILEMAP;
 
@@ -36,8 +113,29 @@ TILEMAP;
 /// > A new tilemap
 TILEMAP* load_tilemap(const char* path);
 
+/// Parse a tilemap from a memory buffer
+/// < data TMX file content
+/// < size Content size in bytes
+/// > A new tilemap, NULL on error
+TILEMAP* parse_tilemap(const char* data, int size);
+
+/// Get a custom property value
+/// < t Tilemap
+/// < owner Owner type
+/// < index Owner index (ignored for the map itself)
+/// < name Property name
+/// > Property value, NULL if not found
+const char* tmx_get_property(TILEMAP* t, int owner, int index, const char* name);
+
+/// Extract spawn points from a tile layer, in row-major order
+/// < t Tilemap
+/// < layer Layer index
+/// < filter Returns true for the tile IDs that create an object
+/// > 0 on success, 1 on error
+int tmx_extract_spawns(TILEMAP* t, int layer, bool (*filter)(int));
+
 /// Destroy a tilemap
 /// < t Tilemap
 void destroy_tilemap(TILEMAP* t);
 
-#endif // __TMXC__
\ No newline at end of file
+#endif // __TMXC__
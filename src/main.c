@@ -8,12 +8,22 @@
 #include "menu/menu.h"
 #include "options.h"
 #include "ending.h"
+#include "game/record.h"
 
 #include "engine/app.h"
 #include "engine/assets.h"
 #include "engine/config.h"
+#include "engine/mapcache.h"
+#include "engine/audio.h"
+
+#include "sim/stage.h"
 
 #include "stdlib.h"
+#include "string.h"
+#include "stdio.h"
+
+/// Compiled map cache directory
+#define MAP_CACHE_DIR "cache"
 
 // Main function
 int main(int argc, char** argv)
@@ -29,12 +39,63 @@ int main(int argc, char** argv)
     };
     int sceneCount = 5;
 
+    // Compiled maps are cached between launches
+    mapcache_init(MAP_CACHE_DIR,stage_is_spawn_tile);
+
+    // Pre-warm the map cache and quit
+    if(argc > 1 && strcmp(argv[1],"--warm-cache") == 0)
+    {
+        return mapcache_warm("assets/global.ass");
+    }
+
     // Load config
     CONFIG c;
     if(read_config(&c,"config.list") != 0)
     {
         return 1;
     }
+    // Audio device settings changed in the options menu override the config
+    read_audio_settings("settings.dat",&c.audioRate,&c.audioBuffer);
+
+    // Audio backend, replays & fast-forward from the command line
+    const char* recordPath = NULL;
+    const char* playPath = NULL;
+    int turboSteps = -1;
+    int turboDrawEvery = 1;
+    int i = 1;
+    for(; i < argc-1; ++ i)
+    {
+        if(strcmp(argv[i],"--audio") == 0 && audio_backend_from_name(argv[i+1]) >= 0)
+        {
+            c.audioBackend = audio_backend_from_name(argv[++ i]);
+        }
+        else if(strcmp(argv[i],"--audio-wav") == 0)
+        {
+            c.audioBackend = AUDIO_BACKEND_WAV;
+            snprintf(c.audioWav,ASSET_PATH_SIZE,"%s",argv[++ i]);
+        }
+        else if(strcmp(argv[i],"--record") == 0)
+        {
+            recordPath = argv[++ i];
+        }
+        else if(strcmp(argv[i],"--play") == 0)
+        {
+            playPath = argv[++ i];
+        }
+        // Fast-forward from the start, updates per frame or
+        // 0 for unbounded
+        else if(strcmp(argv[i],"--turbo") == 0)
+        {
+            turboSteps = (int)strtol(argv[++ i],NULL,10);
+        }
+        else if(strcmp(argv[i],"--turbo-draw") == 0)
+        {
+            turboDrawEvery = (int)strtol(argv[++ i],NULL,10);
+        }
+    }
+    record_init(recordPath,playPath);
+    if(turboSteps >= 0)
+        app_set_turbo(true,turboSteps,turboDrawEvery);
 
     return app_run(scenes,sceneCount,c);
 }
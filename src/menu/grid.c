@@ -9,7 +9,7 @@
 #include "../engine/music.h"
 
 #include "../game/game.h"
-#include "../game/status.h"
+#include "../game/hud.h"
 
 #include "../vpad.h"
 #include "../transition.h"
@@ -48,18 +48,14 @@ static float wave;
 // Change to game scene
 static void change_to_game()
 {
-    int id = cursorPos.y * 5 + cursorPos.x;
-    status_set_if_final(id == 13 -1);
-
-    game_set_stage(get_stage_info(id));
-    app_swap_scene("game");
+    grid_start_stage(cursorPos.y * 5 + cursorPos.x);
 }
 
 
 // Draw info
 static void draw_info()
 {
-    int starCount = status_get_star_count(1);
+    int starCount = hud_get_star_count(1);
     bool isMiddle = cursorPos.x == 2 && cursorPos.y == 2;
 
     if(cursorPos.x == -1) return;
@@ -96,7 +92,7 @@ static void draw_info()
 // Draw buttons
 static void draw_buttons(int dx, int dy)
 {
-    int starCount = status_get_star_count(1);
+    int starCount = hud_get_star_count(1);
 
     int dim = 32;
 
@@ -284,9 +280,9 @@ void grid_update(float tm)
     // Button pressed
     if(vpad_get_button(0) == PRESSED || vpad_get_button(1) == PRESSED)
     {
-        status_set_stage_index(cursorPos.y * 5 + cursorPos.x);
+        hud_set_stage_index(cursorPos.y * 5 + cursorPos.x);
 
-        int starCount = status_get_star_count(1);
+        int starCount = hud_get_star_count(1);
         bool isMiddle = cursorPos.x == 2 && cursorPos.y == 2;
 
         if(starCount < 24 && isMiddle)
@@ -331,4 +327,14 @@ void grid_draw()
     // Draw cursor
     draw_bitmap(bmpBigCursor,DX + vpos.x + 16,
         DY + vpos.y + 16 + (int)round(sin(wave) * 2.0f),0);
+}
+
+
+// Start a stage
+void grid_start_stage(int id)
+{
+    hud_set_if_final(id == 13 -1);
+
+    game_set_stage(id,get_stage_info(id));
+    app_swap_scene("game");
 }
\ No newline at end of file
@@ -16,4 +16,8 @@ void grid_update(float tm);
 /// Draw grid
 void grid_draw();
 
+/// Start a stage
+/// < id Stage index
+void grid_start_stage(int id);
+
 #endif // __GRID__
\ No newline at end of file
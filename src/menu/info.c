@@ -8,6 +8,7 @@
 #include "../lib/parseword.h"
 
 #include "stdlib.h"
+#include "stdio.h"
 
 // A list of stages
 static STAGE_INFO* stages;
@@ -24,6 +25,9 @@ int load_stage_info(int count, const char* path)
     WORDDATA* wd = parse_file(path);
     if(wd == NULL)
     {
+        char err[256];
+        snprintf(err,256,"Failed to open a stage list in %s!",path);
+        SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR,"Error!",err,NULL);
         return 1;
     }
 
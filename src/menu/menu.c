@@ -14,7 +14,8 @@
 #include "../vpad.h"
 #include "../transition.h"
 
-#include "../game/status.h"
+#include "../game/hud.h"
+#include "../game/record.h"
 
 #include "grid.h"
 #include "info.h"
@@ -86,6 +87,14 @@ static int menu_init()
 // Update menu
 static void menu_update(float tm)
 {
+    // Go straight to the stage of a replay played back
+    int stage = record_take_playback_stage();
+    if(stage >= 0)
+    {
+        grid_start_stage(stage);
+        return;
+    }
+
     if(trn_is_active()) return;
     if(title_is_on())
     {
@@ -134,13 +143,13 @@ static void menu_destroy()
 // Scene swapped
 static void menu_on_swap()
 {
-    if(endingPlayed <= 1 && status_get_star_count(2) == 25)
+    if(endingPlayed <= 1 && hud_get_star_count(2) == 25)
     {
         endingPlayed = 2;
         app_swap_scene("ending");
         return;
     }
-    else if(endingPlayed == 0 && status_get_star_count(1) == 25)
+    else if(endingPlayed == 0 && hud_get_star_count(1) == 25)
     {
         endingPlayed = 1;
         app_swap_scene("ending");
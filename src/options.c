@@ -8,6 +8,7 @@
 #include "engine/assets.h"
 #include "engine/sample.h"
 #include "engine/music.h"
+#include "engine/mixer.h"
 
 #include "vpad.h"
 #include "global.h"
@@ -30,6 +31,29 @@ static int cursorPos;
 // Cursor wave
 static float wave;
 
+// Audio device settings, applied on the next launch
+static int audioRate = 44100;
+static int audioBuffer = 512;
+// Have the audio device settings been changed in the
+// menu, otherwise the config file decides them
+static bool audioEdited = false;
+
+// Menu entries
+enum
+{
+    OPT_SOUND = 0,
+    OPT_MUSIC = 1,
+    OPT_RATE = 2,
+    OPT_BUFFER = 3,
+    OPT_FULLSCREEN = 4,
+    OPT_RETURN = 5,
+    OPT_COUNT = 6,
+};
+
+// Selectable rates & buffer sizes
+static const int RATES[] = {22050, 44100, 48000};
+static const int BUFFERS[] = {256, 512, 1024, 2048};
+
 
 // Edit sound value
 static void edit_sound_value(int v, int dir, int p, void (*cb)(int))
@@ -45,6 +69,22 @@ static void edit_sound_value(int v, int dir, int p, void (*cb)(int))
 }
 
 
+// Select the next/previous value from a list
+static void edit_choice(int* v, const int* list, int count, int dir, int p)
+{
+    if(cursorPos != p) return;
+
+    int i = 0;
+    for(; i < count-1 && list[i] < *v; ++ i);
+    i += dir;
+    if(i < 0 || i >= count) return;
+
+    play_sample(sSelect,0.40f);
+    *v = list[i];
+    audioEdited = true;
+}
+
+
 // Draw text
 static void opt_draw_text(int dx, int dy, int h)
 {
@@ -58,13 +98,22 @@ static void opt_draw_text(int dx, int dy, int h)
     char musicStr[16];
     snprintf(musicStr,16,"MUSIC: %d",get_global_music_volume());
 
+    // Changed audio settings are marked, they need a restart
+    MIXER_STATS st = mixer_get_stats();
+    char rateStr[16];
+    snprintf(rateStr,16,"RATE: %d%s",audioRate,audioRate != st.rate ? "*" : "");
+    char bufferStr[16];
+    snprintf(bufferStr,16,"BUFFER: %d%s",audioBuffer,audioBuffer != st.bufferFrames ? "*" : "");
+
     set_bitmap_color(bmpFont,rgb(255,255,0));
     draw_text_with_borders(bmpFont,(Uint8*)"OPTIONS",-1,128,dy,-1,0,true);
     set_bitmap_color(bmpFont,rgb(255,255,255));
     
     draw_text(bmpFont,(Uint8*)soundStr,-1,dx,START_Y + dy,-1,0,false);
     draw_text(bmpFont,(Uint8*)musicStr,-1,dx,START_Y + dy + YOFF,-1,0,false);
-    draw_text(bmpFont,(Uint8*)"FULL SCREEN",-1,dx,START_Y + dy + YOFF*2,-1,0,false);
+    draw_text(bmpFont,(Uint8*)rateStr,-1,dx,START_Y + dy + YOFF*2,-1,0,false);
+    draw_text(bmpFont,(Uint8*)bufferStr,-1,dx,START_Y + dy + YOFF*3,-1,0,false);
+    draw_text(bmpFont,(Uint8*)"FULL SCREEN",-1,dx,START_Y + dy + YOFF*4,-1,0,false);
 
     draw_text(bmpFont,(Uint8*)"Return",-1,dx,dy + h - END_Y,-1,0,false);
 
@@ -86,7 +135,7 @@ static int opt_init()
     sPause = (SAMPLE*)get_asset(ass,"pause");
 
     wave = 0.0f;
-    cursorPos = 3;
+    cursorPos = OPT_RETURN;
 
     return 0;
 }
@@ -107,14 +156,14 @@ static void opt_update(float tm)
     // Select
     if(vpad_get_button(0) == PRESSED || vpad_get_button(1) == PRESSED)
     {
-        if(cursorPos > 1)
+        if(cursorPos >= OPT_FULLSCREEN)
         {
             play_sample(sAccept,0.40f);
         }
 
-        if(cursorPos == 3)
+        if(cursorPos == OPT_RETURN)
             app_swap_to_previous_scene();
-        else if(cursorPos == 2)
+        else if(cursorPos == OPT_FULLSCREEN)
             app_toggle_fullscreen();
     }
 
@@ -127,12 +176,12 @@ static void opt_update(float tm)
     if(delta.y > DELTA && stick.y > DELTA)
     {
         ++ cursorPos;   
-        cursorPos = cursorPos % 4;
+        cursorPos = cursorPos % OPT_COUNT;
     }
     else if(delta.y < -DELTA && stick.y < -DELTA)
     {
         -- cursorPos;   
-        if(cursorPos < 0) cursorPos += 4;
+        if(cursorPos < 0) cursorPos += OPT_COUNT;
     }
 
     // Horizontal movement
@@ -141,13 +190,17 @@ static void opt_update(float tm)
 
     if(delta.x > DELTA && stick.x > DELTA)
     {
-        edit_sound_value(soundVol,1,0, set_global_sample_volume);
-        edit_sound_value(musicVol,1,1, set_global_music_volume);
+        edit_sound_value(soundVol,1,OPT_SOUND, set_global_sample_volume);
+        edit_sound_value(musicVol,1,OPT_MUSIC, set_global_music_volume);
+        edit_choice(&audioRate,RATES,3,1,OPT_RATE);
+        edit_choice(&audioBuffer,BUFFERS,4,1,OPT_BUFFER);
     }
     else if(delta.x < -DELTA && stick.x < -DELTA)
     {
-        edit_sound_value(soundVol,-1,0, set_global_sample_volume);
-        edit_sound_value(musicVol,-1,1, set_global_music_volume);
+        edit_sound_value(soundVol,-1,OPT_SOUND, set_global_sample_volume);
+        edit_sound_value(musicVol,-1,OPT_MUSIC, set_global_music_volume);
+        edit_choice(&audioRate,RATES,3,-1,OPT_RATE);
+        edit_choice(&audioBuffer,BUFFERS,4,-1,OPT_BUFFER);
     }
 
     if(oldPos != cursorPos)
@@ -164,12 +217,12 @@ static void opt_update(float tm)
 static void opt_draw()
 {
     const int WIDTH = 128;
-    const int HEIGHT = 88;
+    const int HEIGHT = 118;
 
     int x = 128 - WIDTH / 2;
     int y = 96 - HEIGHT / 2;
 
-    int yoff = cursorPos == 3 ? 15 : 14;
+    int yoff = cursorPos == OPT_RETURN ? 15 : 14;
 
     // Draw box
     fill_rect(x,y,WIDTH,HEIGHT,rgb(255,255,255));
@@ -192,7 +245,7 @@ static void opt_draw()
 // Swap to options
 static void opt_on_swap()
 {
-    cursorPos = 3;
+    cursorPos = OPT_RETURN;
     wave = 0.0f;
 }
 
@@ -228,6 +281,12 @@ void save_settings(const char* path)
     fwrite(&mvol,1,1,f);
     fwrite(&fscreen,1,1,f);
 
+    // Zero leaves the audio device to the config file
+    Uint16 rate = audioEdited ? (Uint16)audioRate : 0;
+    Uint16 buffer = audioEdited ? (Uint16)audioBuffer : 0;
+    fwrite(&rate,sizeof(Uint16),1,f);
+    fwrite(&buffer,sizeof(Uint16),1,f);
+
     fclose(f);
 }
 
@@ -255,4 +314,30 @@ void read_settings(const char* path)
     
     if(fscreen)
         app_toggle_fullscreen();
-}
\ No newline at end of file
+}
+
+
+// Read audio device settings
+void read_audio_settings(const char* path, int* rate, int* buffer)
+{
+    Uint8 skip[3];
+    Uint16 r, b;
+
+    FILE* f = fopen(path,"rb");
+    if(f != NULL)
+    {
+        // Older settings files do not have these, and
+        // they are zero unless changed in the menu
+        if(fread(skip,1,3,f) == 3 && fread(&r,sizeof(Uint16),1,f) == 1
+         && fread(&b,sizeof(Uint16),1,f) == 1 && r > 0 && b > 0)
+        {
+            *rate = (int)r;
+            *buffer = (int)b;
+            audioEdited = true;
+        }
+        fclose(f);
+    }
+
+    audioRate = *rate;
+    audioBuffer = *buffer;
+}
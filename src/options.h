@@ -18,4 +18,12 @@ void save_settings(const char* path);
 /// < path File path
 void read_settings(const char* path);
 
+/// Read audio device settings. They are only saved once
+/// changed in the options menu, so the values are kept
+/// as they are if the file does not have them
+/// < path File path
+/// < rate Sample rate
+/// < buffer Buffer size in frames
+void read_audio_settings(const char* path, int* rate, int* buffer);
+
 #endif // __OPTIONS__
\ No newline at end of file
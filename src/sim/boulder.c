@@ -3,35 +3,23 @@
 
 #include "boulder.h"
 
-#include "../engine/graphics.h"
-#include "../engine/sample.h"
-
-#include "../vpad.h"
-
+#include "sim.h"
 #include "stage.h"
 #include "player.h"
 #include "objects.h"
 
-#include "stdio.h"
+#include "stdlib.h"
 #include "math.h"
 
-// Boulder bitmap
-static BITMAP* bmpBoulder;
-
-// Sound effects
-static SAMPLE* sThwomp;
-static SAMPLE* sTransf;
-static SAMPLE* sPush;
-
 
 // Get gravity
-static void b_get_gravity(BOULDER* b)
+static void b_get_gravity(GAME_CONTEXT* ctx, BOULDER* b)
 {
     b->falling = false;
     b->gravity = 0.0f;
 
     int oldy = b->y;
-    while(!stage_is_solid(b->x,b->y+1))
+    while(!stage_is_solid(ctx,b->x,b->y+1))
     {
         ++b->y;
     }
@@ -40,30 +28,30 @@ static void b_get_gravity(BOULDER* b)
     {
         b->preventMovement = true;
         b->falling = true;
-        stage_set_collision_tile(b->x,oldy,0);
-        stage_set_collision_tile(b->x,b->y,1);
+        stage_set_collision_tile(ctx,b->x,oldy,0);
+        stage_set_collision_tile(ctx,b->x,b->y,1);
     }
 }
 
 
 // Update boulder location to collision map
-static void b_update_location(BOULDER* b)
+static void b_update_location(GAME_CONTEXT* ctx, BOULDER* b)
 {
-    if(!stage_is_lava(b->x,b->y))
-        stage_set_collision_tile(b->x,b->y,1);
+    if(!stage_is_lava(ctx,b->x,b->y))
+        stage_set_collision_tile(ctx,b->x,b->y,1);
 
     else if(b->spr.frame == 5)
     {
         b->exist = false;
-        stage_set_collision_tile(b->x,b->y,1);
-        stage_set_tile(b->x,b->y,5);
+        stage_set_collision_tile(ctx,b->x,b->y,1);
+        stage_set_tile(ctx,b->x,b->y,5);
         return;
     }
 }
 
 
 // Fall
-static void b_fall(BOULDER* b, float tm)
+static void b_fall(GAME_CONTEXT* ctx, BOULDER* b, float tm)
 {
     const float GRAV_MAX = 4.0f;
     const float GRAV_SPEED = 0.2f;
@@ -71,10 +59,10 @@ static void b_fall(BOULDER* b, float tm)
     float target = b->y*16.0f;
 
     // If close to lava, start changing to soil
-    if(stage_is_lava(b->x,b->y) && fabs(target-b->vpos.y) <= 16.0f)
+    if(stage_is_lava(ctx,b->x,b->y) && fabs(target-b->vpos.y) <= 16.0f)
     {
         b->changing = true;
-        play_sample(sTransf,0.50f);
+        sim_emit(ctx,SIM_EVENT_TRANSFORM,b->x,b->y);
     }
 
     if(b->vpos.y < target)
@@ -92,14 +80,14 @@ static void b_fall(BOULDER* b, float tm)
             b->falling = false;
 
             if(!b->changing)
-                play_sample(sThwomp,0.60f);
+                sim_emit(ctx,SIM_EVENT_THWOMP,b->x,b->y);
         }
     }
 }
 
 
 // Move boulder
-static void b_move(BOULDER* b,float tm)
+static void b_move(GAME_CONTEXT* ctx, BOULDER* b,float tm)
 {
     float target = b->x * 16.0f;
 
@@ -108,60 +96,60 @@ static void b_move(BOULDER* b,float tm)
     if((b->dir == 1 && b->vpos.x > target) || (b->dir == -1 && b->vpos.x < target))
     {
         b->moving = false;
-        b_get_gravity(b);
+        b_get_gravity(ctx,b);
         b->vpos.x = target;
     }
 }
 
 
 // Boulder-player collision
-static void boulder_player_collision(void* o, void* p)
+static void boulder_player_collision(GAME_CONTEXT* ctx, void* o, void* p)
 {
     const float DELTA = 0.1f;
 
     PLAYER* pl = (PLAYER*)p;
     BOULDER* b = (BOULDER*)o;
 
-    if(!b->exist || !obj_can_move()) return;
+    if(!b->exist || !obj_can_move(ctx)) return;
     if(b->moving)
     {
         return;
     }
 
-    VEC2 stick = vpad_get_stick();
+    VEC2 stick = sim_get_input(ctx)->stick;
 
     // Push
     if(pl->canMove && !pl->bouncing && !pl->moving && !b->falling 
        && pl->y == b->y && abs(pl->x-b->x) == 1 
-       && stage_is_solid(pl->x,pl->y+1)
+       && stage_is_solid(ctx,pl->x,pl->y+1)
        && fabs(stick.x) > DELTA)
     {
         b->dir = stick.x > 0.0f ? 1 : -1;
         int pdir = pl->x > b->x ? -1 : 1;
         if(b->dir != pdir) return;
 
-        if(!stage_is_solid(b->x+b->dir,b->y))
+        if(!stage_is_solid(ctx,b->x+b->dir,b->y))
         {
-            stage_set_collision_tile(b->x,b->y,0);
+            stage_set_collision_tile(ctx,b->x,b->y,0);
             b->oldx = b->x;
             b->x += b->dir;
             pl->pushing = true;
             b->moving = true;
 
-            play_sample(sPush,0.60f);
+            sim_emit(ctx,SIM_EVENT_PUSH,b->x,b->y);
         }
     }
 
     // Fall if not being pushed and the player is not moving
-    if(!b->falling && !b->moving && !stage_is_solid(b->x,b->y+1))
+    if(!b->falling && !b->moving && !stage_is_solid(ctx,b->x,b->y+1))
     {
-        b_get_gravity(b);
+        b_get_gravity(ctx,b);
     }
 }
 
 
 // Update boulder
-static void boulder_update(void* o, float tm)
+static void boulder_update(GAME_CONTEXT* ctx, void* o, float tm)
 {
     BOULDER* b = (BOULDER*)o;
     
@@ -170,12 +158,12 @@ static void boulder_update(void* o, float tm)
     if(!b->exist) return;
     if(b->moving)
     {
-        b_move(b,tm);
+        b_move(ctx,b,tm);
     }
     if(b->falling)
     {
         b->preventMovement = true;
-        b_fall(b,tm);
+        b_fall(ctx,b,tm);
     }
 
     if(b->changing)
@@ -189,22 +177,12 @@ static void boulder_update(void* o, float tm)
         spr_animate(&b->spr,0,0,0,0,tm);
     }
 
-    b_update_location(b);
-}
-
-
-// Draw boulder
-static void boulder_draw(void* o)
-{
-    BOULDER* b = (BOULDER*)o;
-    if(b->exist == false) return;
-
-    spr_draw(&b->spr,bmpBoulder,(int)round(b->vpos.x),(int)round(b->vpos.y) +1,0);
+    b_update_location(ctx,b);
 }
 
 
 // Reset boulder
-static void boulder_reset(void* o)
+static void boulder_reset(GAME_CONTEXT* ctx, void* o)
 {
     BOULDER* b = (BOULDER*)o;
     b->exist = true;
@@ -214,34 +192,20 @@ static void boulder_reset(void* o)
     b->spr.frame = 0;
     b->spr.count = 0;
 
-    stage_set_collision_tile(b->x,b->y,1);
-}
-
-
-// Initialize
-void boulder_init(ASSET_PACK* ass)
-{
-    // Get asset
-    bmpBoulder = (BITMAP*)get_asset(ass,"boulder");
-    sThwomp = (SAMPLE*)get_asset(ass,"thwomp");
-    sTransf = (SAMPLE*)get_asset(ass,"transf");
-    sPush = (SAMPLE*)get_asset(ass,"push");
+    stage_set_collision_tile(ctx,b->x,b->y,1);
 }
 
 
 // Create a new boulder
-BOULDER boulder_create(int x, int y)
+BOULDER boulder_create(GAME_CONTEXT* ctx, int x, int y)
 {
     BOULDER b;
 
+    b.type = OBJ_BOULDER;
     b.x = x;
     b.y = y;
     b.vpos = vec2(x*16.0f,y*16.0f);
     b.spr = create_sprite(16,16);
-    b.onDraw = boulder_draw;
-    b.onUpdate = boulder_update;
-    b.onPlayerCollision = boulder_player_collision;
-    b.onReset = boulder_reset;
     b.exist = true;
     b.moving = false;
     b.falling = false;
@@ -250,7 +214,15 @@ BOULDER boulder_create(int x, int y)
     b.oldx = x;
     b.gravity = 0.0f;
 
-    stage_set_collision_tile(b.x,b.y,1);
+    stage_set_collision_tile(ctx,b.x,b.y,1);
 
     return b;
 }
+
+
+// Get the type functions, the collision also makes
+// the boulder fall
+OBJECT_VTABLE boulder_get_vtable()
+{
+    return (OBJECT_VTABLE){boulder_update,boulder_player_collision,boulder_reset,false};
+}
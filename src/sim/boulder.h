@@ -5,7 +5,6 @@
 #define __BOULDER__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -23,14 +22,15 @@ EXTENDS_GAME_OBJECT
 
 AS ( BOULDER );
 
-/// Initialize boulders
-/// < ass Assets
-void boulder_init(ASSET_PACK* ass);
-
 /// Create a new boulder
+/// < ctx Game context
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
 /// > A new boulder
-BOULDER boulder_create(int x, int y);
+BOULDER boulder_create(GAME_CONTEXT* ctx, int x, int y);
+
+/// Get the type functions of boulders
+/// > Type functions
+OBJECT_VTABLE boulder_get_vtable();
 
 #endif // __BOULDER__
\ No newline at end of file
@@ -3,9 +3,7 @@
 
 #include "coin.h"
 
-#include "../engine/graphics.h"
-#include "../engine/sample.h"
-
+#include "sim.h"
 #include "player.h"
 #include "status.h"
 #include "stage.h"
@@ -14,15 +12,9 @@
 #include "stdlib.h"
 #include "math.h"
 
-// Coin bitmap
-static BITMAP* bmpCoin;
-
-// Sound effects
-static SAMPLE* sCoin;
-
 
 // Coin-player collision
-static void coin_player_collision(void* o, void* p)
+static void coin_player_collision(GAME_CONTEXT* ctx, void* o, void* p)
 {
     const float DIST = 8.0f;
 
@@ -38,18 +30,18 @@ static void coin_player_collision(void* o, void* p)
         c->spr.frame = 0;
         c->spr.count = 0;
         c->spr.row = 0;
-        play_sample(sCoin,0.50f);
+        sim_emit(ctx,SIM_EVENT_COIN,c->x,c->y);
 
-        if(c->type == 0)
-            stage_toggle_purple_blocks();
+        if(c->coinType == 0)
+            stage_toggle_purple_blocks(ctx);
         else
-            stage_mutate();
+            stage_mutate(ctx);
     }
 }
 
 
 // Update coin
-static void coin_update(void* o, float tm)
+static void coin_update(GAME_CONTEXT* ctx, void* o, float tm)
 {
     COIN* c = (COIN*)o;
     c->preventMovement = false;
@@ -60,7 +52,7 @@ static void coin_update(void* o, float tm)
     {
         if(c->spr.frame  < 5)
         {
-            spr_animate(&c->spr,1 + c->type*2,0,5,5,tm);
+            spr_animate(&c->spr,1 + c->coinType*2,0,5,5,tm);
         }
         else
         {
@@ -70,7 +62,7 @@ static void coin_update(void* o, float tm)
     }
 
     // Animate
-    spr_animate(&c->spr,c->type*2,7 + c->type*4,0,5,tm);
+    spr_animate(&c->spr,c->coinType*2,7 + c->coinType*4,0,5,tm);
 
     // Float
     c->floatTimer += 0.1f *  tm;
@@ -80,19 +72,8 @@ static void coin_update(void* o, float tm)
 }
 
 
-// Draw coin
-static void coin_draw(void* o)
-{
-    COIN* c = (COIN*)o;
-    if(!c->exist) return;
-
-    spr_draw(&c->spr,bmpCoin,
-        (int)round(c->vpos.x),(int)round(c->vpos.y + sin(c->floatTimer)),0);
-}
-
-
 // Reset coin
-static void coin_reset(void* o)
+static void coin_reset(GAME_CONTEXT* ctx, void* o)
 {
     COIN* c = (COIN*)o;
 
@@ -100,33 +81,28 @@ static void coin_reset(void* o)
 }
 
 
-// Initialize
-void coin_init(ASSET_PACK* ass)
-{
-    // Get assets
-    bmpCoin = (BITMAP*)get_asset(ass,"coin");
-    sCoin = (SAMPLE*)get_asset(ass,"getCoin");
-}
-
-
 // Create a new coin
 COIN coin_create(int x, int y, int type)
 {
     COIN c;
 
+    c.type = OBJ_COIN;
     c.x = x;
     c.y = y;
     c.vpos = vec2(x*16.0f,y*16.0f);
     c.spr = create_sprite(16,16);
-    c.onDraw = coin_draw;
-    c.onUpdate = coin_update;
-    c.onPlayerCollision = coin_player_collision;
-    c.onReset = coin_reset;
     c.exist = true;
     c.dying = false;
     c.preventMovement = false;
     c.floatTimer = 0.0f;
-    c.type = type;
+    c.coinType = type;
 
     return c;
 }
+
+
+// Get the type functions
+OBJECT_VTABLE coin_get_vtable()
+{
+    return (OBJECT_VTABLE){coin_update,coin_player_collision,coin_reset,true};
+}
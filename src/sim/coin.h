@@ -5,7 +5,6 @@
 #define __COIN__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -15,14 +14,10 @@ EXTENDS_GAME_OBJECT
     // Member variables
     float floatTimer;
     bool dying;
-    int type;
+    int coinType;
 
 AS ( COIN );
 
-/// Initialize coins
-/// < ass Assets
-void coin_init(ASSET_PACK* ass);
-
 /// Create a new coin
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
@@ -30,4 +25,8 @@ void coin_init(ASSET_PACK* ass);
 /// > A new coin
 COIN coin_create(int x, int y, int type);
 
+/// Get the type functions of coins
+/// > Type functions
+OBJECT_VTABLE coin_get_vtable();
+
 #endif // __COIN__
\ No newline at end of file
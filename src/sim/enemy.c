@@ -3,27 +3,19 @@
 
 #include "enemy.h"
 
-#include "../engine/graphics.h"
-
-#include "../vpad.h"
-
 #include "stage.h"
 #include "player.h"
-#include "status.h"
 
-#include "stdio.h"
+#include "stdlib.h"
 #include "math.h"
 
 // Global enemy constants
 static float ENEMY_SPEED_DEFAULT = 0.80f;
 
-// Enemy bitmap
-static BITMAP* bmpEnemy;
-
 
 
 // Get gravity
-static void enemy_get_gravity(ENEMY* e)
+static void enemy_get_gravity(GAME_CONTEXT* ctx, ENEMY* e)
 {
     if(e->falling) return;
 
@@ -31,7 +23,7 @@ static void enemy_get_gravity(ENEMY* e)
     e->gravity = 0.0f;
 
     int oldy = e->y;
-    while(!stage_is_solid(e->x,e->y+1))
+    while(!stage_is_solid(ctx,e->x,e->y+1))
     {
         ++e->y;
     }
@@ -40,8 +32,8 @@ static void enemy_get_gravity(ENEMY* e)
     {
         e->preventMovement = true;
         e->falling = true;
-        stage_set_collision_tile(e->x,oldy,0);
-        stage_set_collision_tile(e->x,e->y,1);
+        stage_set_collision_tile(ctx,e->x,oldy,0);
+        stage_set_collision_tile(ctx,e->x,e->y,1);
     }
 }
 
@@ -73,7 +65,7 @@ static void enemy_fall(ENEMY* e, float tm)
 
 
 // Move
-static void enemy_move(ENEMY* e, float tm)
+static void enemy_move(GAME_CONTEXT* ctx, ENEMY* e, float tm)
 {
     bool horizontal = e->id == 0 || e->id == 1 || e->id == 2 || (e->id == 4 && e->spcDir == 0);
     float target = (horizontal ? e->x : e->y) * 16.0f;
@@ -99,14 +91,14 @@ static void enemy_move(ENEMY* e, float tm)
 
         if(e->id ==0 || e->id == 1)
         {
-            enemy_get_gravity(e);
+            enemy_get_gravity(ctx,e);
         }
     }
 }
 
 
 // Boulder-player collision
-static void enemy_player_collision(void* o, void* p)
+static void enemy_player_collision(GAME_CONTEXT* ctx, void* o, void* p)
 {
     PLAYER* pl = (PLAYER*)p;
     ENEMY* e = (ENEMY*)o;
@@ -119,31 +111,31 @@ static void enemy_player_collision(void* o, void* p)
         // Horizontal movement
         if(e->id == 0 || e->id == 2)
         {
-            if(stage_is_solid(e->x+e->dir,e->y)
-             || (e->id == 0 && !stage_is_solid(e->x+e->dir,e->y +1)))
+            if(stage_is_solid(ctx,e->x+e->dir,e->y)
+             || (e->id == 0 && !stage_is_solid(ctx,e->x+e->dir,e->y +1)))
             {
                 e->dir *= -1;
-                if(stage_is_solid(e->x+e->dir,e->y)
-                || (e->id == 0 && !stage_is_solid(e->x+e->dir,e->y +1)))
+                if(stage_is_solid(ctx,e->x+e->dir,e->y)
+                || (e->id == 0 && !stage_is_solid(ctx,e->x+e->dir,e->y +1)))
                 {
                     return;
                 }
             }
-            stage_set_collision_tile(e->x,e->y,0);
+            stage_set_collision_tile(ctx,e->x,e->y,0);
             e->x += e->dir;
         }
         // Vertical movement
         else if(e->id == 3)
         {
-            if(stage_is_solid(e->x,e->y+e->dir) || stage_is_lava(e->x,e->y+e->dir))
+            if(stage_is_solid(ctx,e->x,e->y+e->dir) || stage_is_lava(ctx,e->x,e->y+e->dir))
             {
                 e->dir *= -1;
-                if(stage_is_solid(e->x,e->y+e->dir) || stage_is_lava(e->x,e->y+e->dir))
+                if(stage_is_solid(ctx,e->x,e->y+e->dir) || stage_is_lava(ctx,e->x,e->y+e->dir))
                 {
                     return;
                 }
             }
-            stage_set_collision_tile(e->x,e->y,0);
+            stage_set_collision_tile(ctx,e->x,e->y,0);
             e->y += e->dir;
         }
         // Following movement, horizontal
@@ -162,12 +154,12 @@ static void enemy_player_collision(void* o, void* p)
             {
                 return;
             }
-            if(stage_is_solid(e->x+e->dir,e->y))
+            if(stage_is_solid(ctx,e->x+e->dir,e->y))
             {
                 return;
             }
 
-            stage_set_collision_tile(e->x,e->y,0);
+            stage_set_collision_tile(ctx,e->x,e->y,0);
             e->x += e->dir;
             
         }
@@ -197,13 +189,13 @@ static void enemy_player_collision(void* o, void* p)
                 e->spcDir = 0;
             }
 
-            if((e-> spcDir == 0 && stage_is_solid(e->x+e->dir,e->y)) 
-                || (e-> spcDir == 1 && stage_is_solid(e->x,e->y+e->dir)))
+            if((e-> spcDir == 0 && stage_is_solid(ctx,e->x+e->dir,e->y)) 
+                || (e-> spcDir == 1 && stage_is_solid(ctx,e->x,e->y+e->dir)))
             {
                 return;
             }
 
-            stage_set_collision_tile(e->x,e->y,0);
+            stage_set_collision_tile(ctx,e->x,e->y,0);
 
             if(e->spcDir == 1)
                 e->y += e->dir;
@@ -211,7 +203,7 @@ static void enemy_player_collision(void* o, void* p)
                 e->x += e->dir;
         }
 
-        stage_set_collision_tile(e->x,e->y,1); 
+        stage_set_collision_tile(ctx,e->x,e->y,1); 
         e->moving = true;
     }
 }
@@ -231,7 +223,7 @@ static void enemy_animate(ENEMY* e, float tm)
 
 
 // Update enemy
-static void enemy_update(void* o, float tm)
+static void enemy_update(GAME_CONTEXT* ctx, void* o, float tm)
 {
     ENEMY* e = (ENEMY*)o;
     e->preventMovement = false;
@@ -242,9 +234,9 @@ static void enemy_update(void* o, float tm)
     // If falling, fall
     if(e->id ==0 || e->id == 1)
     {
-        if(!e->moving && !stage_is_solid(e->x,e->y+1))
+        if(!e->moving && !stage_is_solid(ctx,e->x,e->y+1))
         {
-            enemy_get_gravity(e);
+            enemy_get_gravity(ctx,e);
         }
 
         if(e->falling)
@@ -257,56 +249,35 @@ static void enemy_update(void* o, float tm)
     // If moving, move
     if(e->moving)
     {
-        enemy_move(e,tm);
+        enemy_move(ctx,e,tm);
     }
 }
 
 
-// Draw enemy
-static void enemy_draw(void* o)
-{
-    ENEMY* e = (ENEMY*)o;
-    if(e->exist == false) return;
-
-    spr_draw(&e->spr,bmpEnemy,e->vpos.x-4,e->vpos.y-4 +1,e->sprDir);
-    
-}
-
-
 // Reset
-static void enemy_reset(void* o)
+static void enemy_reset(GAME_CONTEXT* ctx, void* o)
 {
     ENEMY* e = (ENEMY*)o;
     if(e->exist == false) return;
 
-    stage_set_collision_tile(e->x,e->y,1);
+    stage_set_collision_tile(ctx,e->x,e->y,1);
     e->moving = false;
     e->dir = e->x % 2 == 0 ? 1 : -1;
 }
 
 
-// Initialize
-void enemy_init(ASSET_PACK* ass)
-{
-    bmpEnemy = (BITMAP*)get_asset(ass,"enemy");
-}
-
-
 // Create a new enemy
-ENEMY enemy_create(int x, int y, int id)
+ENEMY enemy_create(GAME_CONTEXT* ctx, int x, int y, int id)
 {
     ENEMY b;
 
+    b.type = OBJ_ENEMY;
     b.x = x;
     b.y = y;
     b.id = id;
     b.vpos = vec2(x*16.0f,y*16.0f);
     b.spr = create_sprite(24,24);
     b.spr.row = id;
-    b.onDraw = enemy_draw;
-    b.onUpdate = enemy_update;
-    b.onPlayerCollision = enemy_player_collision;
-    b.onReset = enemy_reset;
     b.exist = true;
     b.preventMovement = false;
     b.moving = false;
@@ -316,7 +287,15 @@ ENEMY enemy_create(int x, int y, int id)
     b.falling = false;
     b.spcDir = 0;
 
-    stage_set_collision_tile(b.x,b.y,1);
+    stage_set_collision_tile(ctx,b.x,b.y,1);
 
     return b;
 }
+
+
+// Get the type functions, the collision moves the
+// enemy wherever the player is
+OBJECT_VTABLE enemy_get_vtable()
+{
+    return (OBJECT_VTABLE){enemy_update,enemy_player_collision,enemy_reset,false};
+}
@@ -5,7 +5,6 @@
 #define __ENEMY__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -24,15 +23,16 @@ EXTENDS_GAME_OBJECT
 
 AS ( ENEMY );
 
-/// Initialize enemies
-/// < ass Assets
-void enemy_init(ASSET_PACK* ass);
-
 /// Create a new enemy
+/// < ctx Game context
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
 /// < id Enemy id
 /// > A new enemy
-ENEMY enemy_create(int x, int y, int id);
+ENEMY enemy_create(GAME_CONTEXT* ctx, int x, int y, int id);
+
+/// Get the type functions of enemies
+/// > Type functions
+OBJECT_VTABLE enemy_get_vtable();
 
 #endif // __ENEMY__
\ No newline at end of file
@@ -3,9 +3,7 @@
 
 #include "key.h"
 
-#include "../engine/graphics.h"
-#include "../engine/sample.h"
-
+#include "sim.h"
 #include "player.h"
 #include "status.h"
 
@@ -13,15 +11,9 @@
 #include "stdlib.h"
 #include "math.h"
 
-// Key bitmap
-static BITMAP* bmpKey;
-
-// Sound effects
-static SAMPLE* sKey;
-
 
 // Key-player collision
-static void key_player_collision(void* o, void* p)
+static void key_player_collision(GAME_CONTEXT* ctx, void* o, void* p)
 {
     const float DIST = 8.0f;
 
@@ -34,18 +26,18 @@ static void key_player_collision(void* o, void* p)
     {
         k->flying = true;
         k->preventMovement = true;
-        play_sample(sKey,0.50f);
+        sim_emit(ctx,SIM_EVENT_KEY,k->x,k->y);
     }
 }
 
 
 // Fly
-static void key_fly(KEY* k, float tm)
+static void key_fly(GAME_CONTEXT* ctx, KEY* k, float tm)
 {
     const float ACC = 0.4f;
     const float MAX_SPEED = 6.0f;
 
-    float targetX = 2.0f + status_get_key_count()*13.0f;
+    float targetX = 2.0f + status_get_key_count(ctx)*13.0f;
     float targetY = 4.0f;
 
     k->spr.frame = 0;
@@ -68,13 +60,13 @@ static void key_fly(KEY* k, float tm)
     if(hypot(targetX-k->vpos.x,targetY-k->vpos.y) < 1.0f+k->speedMul)
     {
         k->exist = false;
-        status_add_key();
+        status_add_key(ctx);
     }
 }
 
 
 // Update key
-static void key_update(void* o, float tm)
+static void key_update(GAME_CONTEXT* ctx, void* o, float tm)
 {
     KEY* k = (KEY*)o;
     k->preventMovement = false;
@@ -83,7 +75,7 @@ static void key_update(void* o, float tm)
     // Fly
     if(k->flying)
     {
-        key_fly(k,tm);
+        key_fly(ctx,k,tm);
         k->preventMovement = true;
         return;
     }
@@ -99,19 +91,8 @@ static void key_update(void* o, float tm)
 }
 
 
-// Draw key
-static void key_draw(void* o)
-{
-    KEY* k = (KEY*)o;
-    if(!k->exist) return;
-
-    spr_draw(&k->spr,bmpKey,
-        (int)round(k->vpos.x),(int)round(k->vpos.y + sin(k->floatTimer)),0);
-}
-
-
 // Reset key
-static void key_reset(void* o)
+static void key_reset(GAME_CONTEXT* ctx, void* o)
 {
     KEY* k = (KEY*)o;
 
@@ -119,28 +100,16 @@ static void key_reset(void* o)
 }
 
 
-// Initialize
-void key_init(ASSET_PACK* ass)
-{
-    // Get assets
-    bmpKey = (BITMAP*)get_asset(ass,"key");
-    sKey = (SAMPLE*)get_asset(ass,"getKey");
-}
-
-
 // Create a new key
 KEY key_create(int x, int y)
 {
     KEY k;
 
+    k.type = OBJ_KEY;
     k.x = x;
     k.y = y;
     k.vpos = vec2(x*16.0f,y*16.0f);
     k.spr = create_sprite(16,16);
-    k.onDraw = key_draw;
-    k.onUpdate = key_update;
-    k.onPlayerCollision = key_player_collision;
-    k.onReset = key_reset;
     k.exist = true;
     k.flying = false;
     k.preventMovement = false;
@@ -149,3 +118,10 @@ KEY key_create(int x, int y)
 
     return k;
 }
+
+
+// Get the type functions
+OBJECT_VTABLE key_get_vtable()
+{
+    return (OBJECT_VTABLE){key_update,key_player_collision,key_reset,true};
+}
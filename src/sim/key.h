@@ -5,7 +5,6 @@
 #define __KEY__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -19,14 +18,14 @@ EXTENDS_GAME_OBJECT
 
 AS ( KEY );
 
-/// Initialize keys
-/// < ass Assets
-void key_init(ASSET_PACK* ass);
-
 /// Create a new key
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
 /// > A new key
 KEY key_create(int x, int y);
 
+/// Get the type functions of keys
+/// > Type functions
+OBJECT_VTABLE key_get_vtable();
+
 #endif // __KEY__
\ No newline at end of file
@@ -0,0 +1,108 @@
+/// Lock (source)
+/// (c) 2018 Jani Nykänen
+
+#include "lock.h"
+
+#include "sim.h"
+#include "stage.h"
+#include "player.h"
+#include "status.h"
+
+#include "stdlib.h"
+#include "math.h"
+
+
+// Update lock location to collision map
+static void lock_update_location(GAME_CONTEXT* ctx, LOCK* lock)
+{
+    stage_set_collision_tile(ctx,lock->x,lock->y,1);
+}
+
+
+
+// Boulder-player collision
+static void lock_player_collision(GAME_CONTEXT* ctx, void* o, void* p)
+{
+    const float DELTA = 0.1f;
+
+    PLAYER* pl = (PLAYER*)p;
+    LOCK* lock = (LOCK*)o;
+
+    if(lock->opening || !lock->exist) return;
+   
+    VEC2 stick = sim_get_input(ctx)->stick;
+
+    if(!pl->moving && pl->y == lock->y && abs(pl->x-lock->x) == 1 
+       && fabs(stick.x) > DELTA)
+    {
+        if(status_get_key_count(ctx) > 0)
+        {
+            status_remove_key(ctx);
+            lock->opening = true;
+            lock->preventMovement = true; 
+            stage_set_tile(ctx,lock->x,lock->y,0);
+
+            sim_emit(ctx,SIM_EVENT_LOCK,lock->x,lock->y);
+        }
+    }
+}
+
+
+// Update lock
+static void lock_update(GAME_CONTEXT* ctx, void* o, float tm)
+{
+    LOCK* lock = (LOCK*)o;
+    lock->preventMovement = false;
+    if(!lock->exist) return;
+
+    if(lock->opening)
+    {
+        spr_animate(&lock->spr,0,0,6,6,tm);
+        lock->preventMovement = true;
+        if(lock->spr.frame == 6)
+        {
+            lock->exist = false;
+            stage_set_collision_tile(ctx,lock->x,lock->y,0);
+        }
+        return;
+    }
+
+    lock_update_location(ctx,lock);
+}
+
+
+// Reset lock
+static void lock_reset(GAME_CONTEXT* ctx, void* o)
+{
+    LOCK* lock = (LOCK*)o;
+    
+    lock->opening = false;
+    lock->spr.frame = 0;
+}
+
+
+// Create a new lock
+LOCK lock_create(GAME_CONTEXT* ctx, int x, int y)
+{
+    LOCK b;
+
+    b.type = OBJ_LOCK;
+    b.x = x;
+    b.y = y;
+    b.vpos = vec2(x*16.0f,y*16.0f);
+    b.spr = create_sprite(16,16);
+    b.exist = true;
+    b.opening = false;
+    b.preventMovement = false;
+
+    stage_set_collision_tile(ctx,b.x,b.y,1);
+
+    return b;
+}
+
+
+// Get the type functions
+OBJECT_VTABLE lock_get_vtable()
+{
+    return (OBJECT_VTABLE){lock_update,lock_player_collision,lock_reset,true};
+}
@@ -5,7 +5,6 @@
 #define __LOCK__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -17,14 +16,15 @@ EXTENDS_GAME_OBJECT
 
 AS ( LOCK );
 
-/// Initialize locks
-/// < ass Assets
-void lock_init(ASSET_PACK* ass);
-
 /// Create a new lock
+/// < ctx Game context
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
 /// > A new lock
-LOCK lock_create(int x, int y);
+LOCK lock_create(GAME_CONTEXT* ctx, int x, int y);
+
+/// Get the type functions of locks
+/// > Type functions
+OBJECT_VTABLE lock_get_vtable();
 
 #endif // __LOCK__
\ No newline at end of file
@@ -0,0 +1,22 @@
+/// Game object base (source)
+/// (c) 2018 Jani Nykänen
+
+#include "obase.h"
+
+#include "stdlib.h"
+
+
+// Reset
+void object_reset(GAME_CONTEXT* ctx, const OBJECT_VTABLE* vt, OBJECT* o)
+{
+    o->x = o->startPos.x;
+    o->y = o->startPos.y;
+    o->vpos.x = o->x * 16.0f;
+    o->vpos.y = o->y * 16.0f;
+    o->exist = true;
+
+    if(vt->onReset != NULL)
+    {
+        vt->onReset(ctx,o);
+    }
+}
\ No newline at end of file
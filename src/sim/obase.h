@@ -0,0 +1,63 @@
+/// Game object base (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __GOBJ_BASE__
+#define __GOBJ_BASE__
+
+#include "../engine/vector.h"
+#include "../engine/sprite.h"
+
+#include "stdbool.h"
+
+/// Game context, defined in sim.h
+typedef struct GAME_CONTEXT GAME_CONTEXT;
+
+/// Object types
+enum
+{
+    OBJ_PLAYER = 0,
+    OBJ_BOULDER = 1,
+    OBJ_ENEMY = 2,
+    OBJ_KEY = 3,
+    OBJ_LOCK = 4,
+    OBJ_COIN = 5,
+    OBJ_STAR = 6,
+    OBJ_TYPE_COUNT = 7,
+};
+
+/// Object type functions, shared by all the objects
+/// of a type
+typedef struct
+{
+    void (*onUpdate) (GAME_CONTEXT*,void*,float);
+    void (*onPlayerCollision)(GAME_CONTEXT*,void*,void*);
+    void (*onReset)(GAME_CONTEXT*,void*);
+    /// The collision does nothing unless the player is in
+    /// the cell of the object or next to it, & the object
+    /// does not move while it can collide
+    bool contactOnly;
+}
+OBJECT_VTABLE;
+
+#define EXTENDS_GAME_OBJECT typedef struct\
+{\
+int type;\
+int x;\
+int y;\
+POINT startPos;\
+VEC2 vpos;\
+SPRITE spr;\
+bool exist;\
+bool preventMovement;\
+
+#define AS(name) }name;
+
+EXTENDS_GAME_OBJECT AS (OBJECT);
+
+/// Reset object
+/// < ctx Game context
+/// < vt Type functions of the object
+/// < o Object to reset
+void object_reset(GAME_CONTEXT* ctx, const OBJECT_VTABLE* vt, OBJECT* o);
+
+#endif // __GOBJ_BASE__
\ No newline at end of file
@@ -0,0 +1,440 @@
+/// Game objects (source)
+/// (c) 2018 Jani Nykänen
+
+#include "objects.h"
+
+#include "boulder.h"
+#include "key.h"
+#include "star.h"
+#include "player.h"
+#include "lock.h"
+#include "enemy.h"
+#include "coin.h"
+#include "stage.h"
+#include "sim.h"
+#include "zobrist.h"
+
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+
+// Pool alignment
+#define POOL_ALIGN 16
+
+
+// Get the object type of a spawn tile, -1 if none
+static int spawn_type(int id)
+{
+    if(id == 19 || id == 26) return OBJ_COIN;
+    if(id >= 11 && id <= 16) return OBJ_ENEMY;
+    if(id == 10) return OBJ_BOULDER;
+    if(id == 9) return OBJ_STAR;
+    if(id == 8) return OBJ_KEY;
+    if(id == 7) return OBJ_PLAYER;
+    if(id == 6) return OBJ_LOCK;
+
+    return -1;
+}
+
+
+// Set the size & the functions of a pool
+static void init_pool(OBJECT_POOL* p, int type)
+{
+    switch(type)
+    {
+    case OBJ_BOULDER:
+        p->size = sizeof(BOULDER);
+        p->vt = boulder_get_vtable();
+        break;
+
+    case OBJ_ENEMY:
+        p->size = sizeof(ENEMY);
+        p->vt = enemy_get_vtable();
+        break;
+
+    case OBJ_KEY:
+        p->size = sizeof(KEY);
+        p->vt = key_get_vtable();
+        break;
+
+    case OBJ_LOCK:
+        p->size = sizeof(LOCK);
+        p->vt = lock_get_vtable();
+        break;
+
+    case OBJ_COIN:
+        p->size = sizeof(COIN);
+        p->vt = coin_get_vtable();
+        break;
+
+    case OBJ_STAR:
+        p->size = sizeof(STAR);
+        p->vt = star_get_vtable();
+        break;
+
+    default:
+        p->size = 0;
+        p->vt = (OBJECT_VTABLE){NULL,NULL,NULL,false};
+        break;
+    }
+}
+
+
+// Get the pool memory size, aligned
+static size_t pool_bytes(OBJECT_POOL* p)
+{
+    size_t bytes = p->size * p->capacity;
+    return (bytes + POOL_ALIGN-1) / POOL_ALIGN * POOL_ALIGN;
+}
+
+
+// Get the cell of an object, -1 if it is not indexed
+static int object_cell(GAME_CONTEXT* ctx, OBJECT* o)
+{
+    POINT dim = stage_get_map_size(ctx);
+
+    if(!o->exist || o->x < 0 || o->y < 0 || o->x >= dim.x || o->y >= dim.y)
+        return -1;
+
+    return o->y*dim.x + o->x;
+}
+
+
+// Move an object to another cell in the index
+static void index_move(OBJECT_LIST* l, int i, int cell)
+{
+    short* p;
+
+    if(l->cellOf[i] == cell) return;
+
+    if(l->cellOf[i] >= 0)
+    {
+        for(p = &l->cellHead[l->cellOf[i]]; *p != i; p = &l->cellNext[*p]);
+        *p = l->cellNext[i];
+    }
+
+    l->cellOf[i] = (short)cell;
+    if(cell >= 0)
+    {
+        l->cellNext[i] = l->cellHead[cell];
+        l->cellHead[cell] = (short)i;
+    }
+}
+
+
+// Mark the objects in a cell as near the player
+static void mark_cell(GAME_CONTEXT* ctx, int x, int y)
+{
+    OBJECT_LIST* l = &ctx->obj;
+    POINT dim = stage_get_map_size(ctx);
+    int i;
+
+    if(x < 0 || y < 0 || x >= dim.x || y >= dim.y) return;
+
+    for(i = l->cellHead[y*dim.x + x]; i >= 0; i = l->cellNext[i])
+    {
+        l->nearTick[i] = l->tick;
+    }
+}
+
+
+// Mark the objects the player can touch in this tick:
+// the ones within a cell from the drawn position, & the
+// ones in the same row next to the grid position
+static void mark_near(GAME_CONTEXT* ctx)
+{
+    PLAYER* pl = &ctx->obj.player;
+    int cx = (int)floorf(pl->vpos.x / 16.0f);
+    int cy = (int)floorf(pl->vpos.y / 16.0f);
+    int x, y;
+
+    ++ ctx->obj.tick;
+
+    for(y = cy; y <= cy+1; ++ y)
+    {
+        for(x = cx; x <= cx+1; ++ x)
+        {
+            mark_cell(ctx,x,y);
+        }
+    }
+    for(x = pl->x-1; x <= pl->x+1; ++ x)
+    {
+        mark_cell(ctx,x,pl->y);
+    }
+}
+
+
+// Reset
+void obj_reset(GAME_CONTEXT* ctx)
+{
+    OBJECT_POOL* p;
+    int t = 0;
+    int i;
+
+    for(; t < OBJ_TYPE_COUNT; ++ t)
+    {
+        p = &ctx->obj.pools[t];
+        for(i = 0; i < p->count; ++ i)
+        {
+            object_reset(ctx,&p->vt,obj_pool_get(p,i));
+        }
+    }
+    pl_reset(ctx,&ctx->obj.player);
+
+    obj_sync_index(ctx);
+}
+
+
+// Update objects. The objects push each other & change
+// the stage, so they are updated in the spawn order, not
+// type by type
+void obj_update(GAME_CONTEXT* ctx, float tm)
+{
+    OBJECT* pl = (OBJECT*)&ctx->obj.player;
+    const OBJECT_VTABLE* vt;
+    OBJECT* o;
+    int i = 0;
+
+    ctx->obj.canMove = true;
+    mark_near(ctx);
+
+    // Update game objects. An object only moves itself,
+    // so it is re-indexed after its own turn
+    for(; i < ctx->obj.count; ++ i)
+    {
+        o = ctx->obj.objects[i];
+        vt = &ctx->obj.pools[o->type].vt;
+        vt->onUpdate(ctx,o,tm);
+        if(!vt->contactOnly || ctx->obj.nearTick[i] == ctx->obj.tick)
+            vt->onPlayerCollision(ctx,o,pl);
+
+        if(o->preventMovement)
+            ctx->obj.canMove = false;
+
+        index_move(&ctx->obj,i,object_cell(ctx,o));
+    }
+
+    // Update player
+    pl_update(ctx,&ctx->obj.player,tm);
+    stage_player_elec_collision(ctx,(void*)&ctx->obj.player);
+
+    zobrist_update_objects(ctx);
+}
+
+
+// Reserve
+void obj_reserve(GAME_CONTEXT* ctx, int id)
+{
+    int type = spawn_type(id);
+    if(type > OBJ_PLAYER)
+        ++ ctx->obj.pools[type].capacity;
+}
+
+
+// Allocate
+int obj_alloc(GAME_CONTEXT* ctx)
+{
+    OBJECT_POOL* p;
+    unsigned char* mem;
+    size_t bytes = 0;
+    int count = 0;
+    int t = 0;
+
+    for(; t < OBJ_TYPE_COUNT; ++ t)
+    {
+        p = &ctx->obj.pools[t];
+        init_pool(p,t);
+        p->count = 0;
+
+        bytes += pool_bytes(p);
+        count += p->capacity;
+    }
+    bytes += (sizeof(OBJECT*) + sizeof(int)*2 + sizeof(short)*2) * count;
+
+    free(ctx->obj.arena);
+    ctx->obj.arena = (unsigned char*)malloc(bytes > 0 ? bytes : 1);
+    if(ctx->obj.arena == NULL) return 1;
+
+    // The pools first, then the object order & the hashes
+    mem = ctx->obj.arena;
+    for(t = 0; t < OBJ_TYPE_COUNT; ++ t)
+    {
+        p = &ctx->obj.pools[t];
+        p->data = mem;
+        mem += pool_bytes(p);
+    }
+    ctx->obj.objects = (OBJECT**)mem;
+    mem += sizeof(OBJECT*) * count;
+    ctx->obj.hashed = (int*)mem;
+    mem += sizeof(int) * count;
+    ctx->obj.nearTick = (unsigned int*)mem;
+    mem += sizeof(int) * count;
+    ctx->obj.cellNext = (short*)mem;
+    mem += sizeof(short) * count;
+    ctx->obj.cellOf = (short*)mem;
+    ctx->obj.count = 0;
+
+    // Empty index
+    memset(ctx->obj.cellHead,0xFF,sizeof(ctx->obj.cellHead));
+    memset(ctx->obj.cellOf,0xFF,sizeof(short) * count);
+    memset(ctx->obj.nearTick,0,sizeof(int) * count);
+    ctx->obj.tick = 0;
+
+    return 0;
+}
+
+
+// Add an object
+int obj_add(GAME_CONTEXT* ctx, int id, int x, int y)
+{
+    int type = spawn_type(id);
+
+    if(type == OBJ_PLAYER)
+    {
+        ctx->obj.player = pl_create(x,y);
+        return 0;
+    }
+    else if(type < 0)
+    {
+        return 0;
+    }
+
+    // Out of reserved room
+    OBJECT_POOL* p = &ctx->obj.pools[type];
+    if(p->count >= p->capacity)
+        return 1;
+
+    OBJECT* o = obj_pool_get(p,p->count ++);
+    switch(type)
+    {
+    case OBJ_COIN:
+        *((COIN*)o) = coin_create(x,y,id == 26 ? 1 : 0);
+        break;
+
+    case OBJ_ENEMY:
+        *((ENEMY*)o) = enemy_create(ctx,x,y,id-11);
+        break;
+
+    case OBJ_BOULDER:
+        *((BOULDER*)o) = boulder_create(ctx,x,y);
+        break;
+
+    case OBJ_STAR:
+        *((STAR*)o) = star_create(x,y);
+        break;
+
+    case OBJ_KEY:
+        *((KEY*)o) = key_create(x,y);
+        break;
+
+    case OBJ_LOCK:
+        *((LOCK*)o) = lock_create(ctx,x,y);
+        break;
+
+    default:
+        break;
+    }
+    o->startPos = point(x,y);
+    ctx->obj.objects[ctx->obj.count] = o;
+    index_move(&ctx->obj,ctx->obj.count,object_cell(ctx,o));
+    ++ ctx->obj.count;
+
+    return 0;
+}
+
+
+// Can move
+bool obj_can_move(GAME_CONTEXT* ctx)
+{
+    return ctx->obj.canMove;
+}
+
+
+// Get object count
+int obj_get_count(GAME_CONTEXT* ctx)
+{
+    return ctx->obj.count;
+}
+
+
+// Get an object
+OBJECT* obj_get(GAME_CONTEXT* ctx, int i)
+{
+    return ctx->obj.objects[i];
+}
+
+
+// Get objects at
+int obj_get_at(GAME_CONTEXT* ctx, int x, int y, int* out, int max)
+{
+    OBJECT_LIST* l = &ctx->obj;
+    POINT dim = stage_get_map_size(ctx);
+    int count = 0;
+    int i;
+
+    if(x < 0 || y < 0 || x >= dim.x || y >= dim.y) return 0;
+
+    for(i = l->cellHead[y*dim.x + x]; i >= 0 && count < max; i = l->cellNext[i])
+    {
+        out[count ++] = i;
+    }
+    return count;
+}
+
+
+// Sync index
+void obj_sync_index(GAME_CONTEXT* ctx)
+{
+    int i = 0;
+    for(; i < ctx->obj.count; ++ i)
+    {
+        index_move(&ctx->obj,i,object_cell(ctx,ctx->obj.objects[i]));
+    }
+}
+
+
+// Get a pool
+OBJECT_POOL* obj_get_pool(GAME_CONTEXT* ctx, int type)
+{
+    return &ctx->obj.pools[type];
+}
+
+
+// Get an object in a pool
+OBJECT* obj_pool_get(OBJECT_POOL* p, int i)
+{
+    return (OBJECT*)(p->data + p->size*i);
+}
+
+
+// Reset an object
+void obj_reset_object(GAME_CONTEXT* ctx, OBJECT* o)
+{
+    object_reset(ctx,&ctx->obj.pools[o->type].vt,o);
+}
+
+
+// Get the player
+PLAYER* obj_get_player(GAME_CONTEXT* ctx)
+{
+    return &ctx->obj.player;
+}
+
+
+// Clear objects
+void obj_clear(GAME_CONTEXT* ctx)
+{
+    int t = 0;
+    for(; t < OBJ_TYPE_COUNT; ++ t)
+    {
+        ctx->obj.pools[t].count = 0;
+        ctx->obj.pools[t].capacity = 0;
+    }
+
+    free(ctx->obj.arena);
+    ctx->obj.arena = NULL;
+    ctx->obj.objects = NULL;
+    ctx->obj.hashed = NULL;
+    ctx->obj.count = 0;
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+/// Game objects (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __GAME_OBJECTS__
+#define __GAME_OBJECTS__
+
+#include "obase.h"
+#include "player.h"
+#include "stage.h"
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/// Objects of one type, stored in a row
+typedef struct
+{
+    unsigned char* data; /// Objects
+    size_t size; /// Object size
+    int count; /// Object count
+    int capacity; /// Room reserved for objects
+    OBJECT_VTABLE vt; /// Type functions
+}
+OBJECT_POOL;
+
+/// Object list. The objects live in per-type pools
+/// allocated from one arena when the stage is loaded.
+/// The existing objects are indexed by the cell they
+/// are in, a linked list per cell
+typedef struct
+{
+    OBJECT_POOL pools[OBJ_TYPE_COUNT]; /// Pools by type, no player pool
+    OBJECT** objects; /// Objects in the spawn order
+    int count; /// Object count
+    unsigned char* arena; /// Memory of the pools & the arrays
+
+    short cellHead[STAGE_MAX_TILES]; /// First object in each cell, -1 if none
+    short* cellNext; /// Next object in the same cell, -1 if none
+    short* cellOf; /// Cell each object is indexed in, -1 if none
+    unsigned int* nearTick; /// Last tick the object was near the player
+    unsigned int tick; /// Update count
+    PLAYER player; /// Player object
+    bool canMove; /// Have the obstacles stopped moving/acting
+
+    int* hashed; /// Object values in the Zobrist hash
+    int playerHashed; /// Player value in the Zobrist hash
+}
+OBJECT_LIST;
+
+/// Reset game objects
+/// < ctx Game context
+void obj_reset(GAME_CONTEXT* ctx);
+
+/// Update objects
+/// < ctx Game context
+/// < tm Time mul.
+void obj_update(GAME_CONTEXT* ctx, float tm);
+
+/// Reserve room for an object of a spawn tile. Call for
+/// all the spawns of a stage before allocating
+/// < ctx Game context
+/// < id Type identifier
+void obj_reserve(GAME_CONTEXT* ctx, int id);
+
+/// Allocate the reserved room
+/// < ctx Game context
+/// > 0 on success, 1 on error
+int obj_alloc(GAME_CONTEXT* ctx);
+
+/// Add an object to the reserved room
+/// < ctx Game context
+/// < id Type identifier
+/// < x X coordinate (in grid)
+/// < y Y coordinate (in grid)
+/// > 0 on success, 1 on error
+int obj_add(GAME_CONTEXT* ctx, int id, int x, int y);
+
+/// Get object count (the player excluded)
+/// < ctx Game context
+/// > Object count
+int obj_get_count(GAME_CONTEXT* ctx);
+
+/// Get an object
+/// < ctx Game context
+/// < i Index
+/// > Object
+OBJECT* obj_get(GAME_CONTEXT* ctx, int i);
+
+/// Get the objects in a cell
+/// < ctx Game context
+/// < x X coordinate (in grid)
+/// < y Y coordinate (in grid)
+/// < out Object indices
+/// < max Room in the output
+/// > Object count
+int obj_get_at(GAME_CONTEXT* ctx, int x, int y, int* out, int max);
+
+/// Re-index all the objects after placing them
+/// outside the update
+/// < ctx Game context
+void obj_sync_index(GAME_CONTEXT* ctx);
+
+/// Get a pool
+/// < ctx Game context
+/// < type Object type
+/// > Pool
+OBJECT_POOL* obj_get_pool(GAME_CONTEXT* ctx, int type);
+
+/// Get an object in a pool
+/// < p Pool
+/// < i Index
+/// > Object
+OBJECT* obj_pool_get(OBJECT_POOL* p, int i);
+
+/// Reset an object to its start
+/// < ctx Game context
+/// < o Object
+void obj_reset_object(GAME_CONTEXT* ctx, OBJECT* o);
+
+/// Get the player
+/// < ctx Game context
+/// > Player
+PLAYER* obj_get_player(GAME_CONTEXT* ctx);
+
+/// Get if the obstacles have stopped moving/acting
+/// < ctx Game context
+/// > True or false
+bool obj_can_move(GAME_CONTEXT* ctx);
+
+/// Clear objects from the memory
+/// < ctx Game context
+void obj_clear(GAME_CONTEXT* ctx);
+
+#endif // __GAME_OBJECTS__
\ No newline at end of file
@@ -3,17 +3,10 @@
 
 #include "player.h"
 
-#include "../engine/graphics.h"
-#include "../engine/music.h"
-#include "../engine/sample.h"
-
-#include "../vpad.h"
-#include "../transition.h"
-
+#include "sim.h"
 #include "stage.h"
 #include "objects.h"
 #include "status.h"
-#include "game.h"
 
 #include "math.h"
 #include "stdio.h"
@@ -25,52 +18,45 @@ static float PL_GRAVITY_MAX = 4.0f;
 static float PL_GRAVITY_DELTA = 0.1f;
 static const float STICK_DELTA = 0.1f;
 
-// Player bitmap
-static BITMAP* bmpPlayer;
-
-// Sound effects
-static SAMPLE* sJump;
-static SAMPLE* sDie;
-
 
 // Death check
-static void pl_death_check(PLAYER* pl)
+static void pl_death_check(GAME_CONTEXT* ctx, PLAYER* pl)
 {
-    int harm = stage_is_harmful(pl->x,pl->y);
+    int harm = stage_is_harmful(ctx,pl->x,pl->y);
     if(!pl->jumping && !pl->falling && harm > 0)
     {
         pl->dying = true;
         pl->deathMode = harm;
 
-        fade_out_music(500);
+        sim_emit(ctx,SIM_EVENT_DEATH,pl->x,pl->y);
     }
 }
 
 
 // Get gravity
-static bool pl_get_gravity(PLAYER* pl)
+static bool pl_get_gravity(GAME_CONTEXT* ctx, PLAYER* pl)
 {
     pl->checkGravity = false;
 
     if(pl->moving) return false;
 
-    POINT dim = stage_get_map_size();
+    POINT dim = stage_get_map_size(ctx);
     int y = pl->y;
     
-    if(pl->y == dim.y-1 || stage_is_vine(pl->x,pl->y)) return false;
-    if(stage_is_solid(pl->x,++y)) return false;
+    if(pl->y == dim.y-1 || stage_is_vine(ctx,pl->x,pl->y)) return false;
+    if(stage_is_solid(ctx,pl->x,++y)) return false;
 
     int oldx = pl->x;
     int oldy = pl->y;
 
     for(; y < dim.y; ++ y)
     {
-        if(stage_is_solid(pl->x,y))
+        if(stage_is_solid(ctx,pl->x,y))
         {
             break;
             
         }
-        else if(stage_is_vine(pl->x,pl->y))
+        else if(stage_is_vine(ctx,pl->x,pl->y))
         {
             y --;
             break;
@@ -84,17 +70,18 @@ static bool pl_get_gravity(PLAYER* pl)
     pl->climbing = false;
     pl->falling = true;
 
-    stage_set_collision_tile(oldx,oldy,0);
-    stage_set_collision_tile(pl->x,pl->y,1);
+    stage_set_collision_tile(ctx,oldx,oldy,0);
+    stage_set_collision_tile(ctx,pl->x,pl->y,1);
 
     return true;
 }
 
 
 // Bounce
-static void pl_bounce(PLAYER* pl)
+static void pl_bounce(GAME_CONTEXT* ctx, PLAYER* pl)
 {
-    VEC2 stick = vpad_get_stick();
+    const SIM_INPUT* in = sim_get_input(ctx);
+    VEC2 stick = in->stick;
 
     // Direction
     if(fabs(stick.x) > STICK_DELTA)
@@ -103,7 +90,7 @@ static void pl_bounce(PLAYER* pl)
     }
 
     // If jump button released, start jumping
-    if(pl->spr.frame >= 2 && (vpad_get_button(0) == RELEASED || vpad_get_button(0) == UP))
+    if(pl->spr.frame >= 2 && (in->jump == SIM_BUTTON_RELEASED || in->jump == SIM_BUTTON_UP))
     {
         int d = pl->dir == 0 ? 1 : -1;
 
@@ -114,9 +101,9 @@ static void pl_bounce(PLAYER* pl)
         pl->jumping = true;
 
         pl->speed = PL_JUMP_SPEED;
-        if(stage_is_solid(pl->x+d,pl->y))
+        if(stage_is_solid(ctx,pl->x+d,pl->y))
         {
-            if(!stage_is_solid(pl->x,pl->y-1) && !stage_is_solid(pl->x+d,pl->y-1))
+            if(!stage_is_solid(ctx,pl->x,pl->y-1) && !stage_is_solid(ctx,pl->x+d,pl->y-1))
             {
                 -- pl->y;
                 pl->x += d;
@@ -131,19 +118,19 @@ static void pl_bounce(PLAYER* pl)
         }
         else
         {
-            if(stage_is_solid(pl->x,pl->y-1))
+            if(stage_is_solid(ctx,pl->x,pl->y-1))
             {
                 pl->x += d;
                 pl->gravity = -1.0f;
             }
-            else if(stage_is_solid(pl->x+d,pl->y-1))
+            else if(stage_is_solid(ctx,pl->x+d,pl->y-1))
             {
                 pl->x += d;
                 pl->gravity = -1.0f;
             }
-            else if(stage_is_solid(pl->x+d*2,pl->y) || stage_is_solid(pl->x+d*2,pl->y-1))
+            else if(stage_is_solid(ctx,pl->x+d*2,pl->y) || stage_is_solid(ctx,pl->x+d*2,pl->y-1))
             {
-                if(stage_is_solid(pl->x+d*2,pl->y-1))
+                if(stage_is_solid(ctx,pl->x+d*2,pl->y-1))
                 {
                     pl->x += d;
                     pl->gravity = -1.625f;
@@ -170,11 +157,11 @@ static void pl_bounce(PLAYER* pl)
         pl->target.x = pl->x * 16.0f;
         pl->target.y = pl->y * 16.0f;
         
-        stage_set_collision_tile(oldx,oldy,0);
-        stage_set_collision_tile(pl->x,pl->y,1);
-        status_add_turn();
+        stage_set_collision_tile(ctx,oldx,oldy,0);
+        stage_set_collision_tile(ctx,pl->x,pl->y,1);
+        status_add_turn(ctx);
 
-        play_sample(sJump,0.40f);
+        sim_emit(ctx,SIM_EVENT_JUMP,pl->x,pl->y);
         
         pl->oldPos = point(oldx,oldy);
     }
@@ -182,21 +169,22 @@ static void pl_bounce(PLAYER* pl)
 
 
 // Control
-static void pl_control(PLAYER* pl)
+static void pl_control(GAME_CONTEXT* ctx, PLAYER* pl)
 {
-    if(!obj_can_move() || pl->moving || pl->jumping) return;
-    if(pl->checkGravity && pl_get_gravity(pl)) return;
+    if(!obj_can_move(ctx) || pl->moving || pl->jumping) return;
+    if(pl->checkGravity && pl_get_gravity(ctx,pl)) return;
 
     pl->falling = false;
     pl->gravity = 0.0f;
 
-    VEC2 stick = vpad_get_stick();
+    const SIM_INPUT* in = sim_get_input(ctx);
+    VEC2 stick = in->stick;
     int oldx = pl->x;
     int oldy = pl->y;
     int d = 0;
 
     // Jump button pressed
-    if(!pl->bouncing && vpad_get_button(0) == PRESSED)
+    if(!pl->bouncing && in->jump == SIM_BUTTON_PRESSED)
     {   
         pl->bouncing = true;
         pl->spr.count = 0.0f;
@@ -207,7 +195,7 @@ static void pl_control(PLAYER* pl)
     // Bounce
     if(pl->bouncing)
     {
-        pl_bounce(pl);
+        pl_bounce(ctx,pl);
         return;
     }
 
@@ -231,8 +219,8 @@ static void pl_control(PLAYER* pl)
     // Check if it's possible to move
     if(pl->moving)
     {
-        if( stage_is_solid(pl->x,pl->y) 
-            || (pl->climbing && (!stage_is_vine(pl->x,pl->y) && pl->y <= oldy) ) )
+        if( stage_is_solid(ctx,pl->x,pl->y) 
+            || (pl->climbing && (!stage_is_vine(ctx,pl->x,pl->y) && pl->y <= oldy) ) )
         {
             pl->moving = false;
             pl->x = oldx;
@@ -247,9 +235,9 @@ static void pl_control(PLAYER* pl)
 
             pl->speed = PL_SPEED_DEFAULT;
 
-            stage_set_collision_tile(oldx,oldy,0);
-            stage_set_collision_tile(pl->x,pl->y,1);
-            status_add_turn();
+            stage_set_collision_tile(ctx,oldx,oldy,0);
+            stage_set_collision_tile(ctx,pl->x,pl->y,1);
+            status_add_turn(ctx);
         }
     }
 }
@@ -322,7 +310,7 @@ static void pl_move(PLAYER* pl, float tm)
 
 
 // Animate player
-static void pl_animate(PLAYER* pl, float tm)
+static void pl_animate(GAME_CONTEXT* ctx, PLAYER* pl, float tm)
 {
     if(pl->waitTimer > 0.0f)
         pl->waitTimer -= 1.0f * tm;
@@ -335,16 +323,19 @@ static void pl_animate(PLAYER* pl, float tm)
     // Dying
     else if(pl->dying)
     {
+        // The animation stops at the last frame, the
+        // stage is reset by the observer
         int oldframe = pl->spr.frame;
+        if(oldframe == 7) return;
+
         spr_animate(&pl->spr,4 +pl->deathMode,0,7,pl->spr.frame == 0 ? 20 : 6,tm);
         if(oldframe == 0 && pl->spr.frame > 0)
         {
-            stage_set_shake_timer(60.0f);
-            play_sample(sDie,0.40f);
+            sim_emit(ctx,SIM_EVENT_DEATH_HIT,pl->x,pl->y);
         }
         if(pl->spr.frame == 7)
         {
-            trn_set(FADE_IN,BLACK_VERTICAL,1.0f,game_reset);
+            sim_emit(ctx,SIM_EVENT_DEATH_END,pl->x,pl->y);
         }
     }
     // Bouncing
@@ -367,7 +358,7 @@ static void pl_animate(PLAYER* pl, float tm)
     else if(!pl->moving)
     {
         
-        if(stage_is_vine(pl->x,pl->y) && !stage_is_solid(pl->x,pl->y +1))
+        if(stage_is_vine(ctx,pl->x,pl->y) && !stage_is_solid(ctx,pl->x,pl->y +1))
         {
             spr_animate(&pl->spr,3,0,0,0,tm);
         }
@@ -399,18 +390,8 @@ static void pl_animate(PLAYER* pl, float tm)
 }
 
 
-// Initialize player
-void pl_init(ASSET_PACK* ass)
-{
-    // Set assets
-    bmpPlayer = (BITMAP*)get_asset(ass,"player");
-    sJump = (SAMPLE*)get_asset(ass,"jump");
-    sDie = (SAMPLE*)get_asset(ass,"die");
-}
-
-
 // Reset player
-void pl_reset(PLAYER* pl)
+void pl_reset(GAME_CONTEXT* ctx, PLAYER* pl)
 {
     pl->x = pl->startPos.x;
     pl->y = pl->startPos.y;
@@ -437,6 +418,7 @@ void pl_reset(PLAYER* pl)
 PLAYER pl_create(int x, int y)
 {
     PLAYER pl;
+    pl.type = OBJ_PLAYER;
     pl.x = x;
     pl.y = y;
     pl.startPos = point(x,y);
@@ -471,36 +453,29 @@ PLAYER pl_create(int x, int y)
 
 
 // Update player
-void pl_update(PLAYER* pl, float tm)
+void pl_update(GAME_CONTEXT* ctx, PLAYER* pl, float tm)
 {
     pl->startedMoving = false;
 
     if(!pl->dying && !pl->victorous)
     {
-        pl_death_check(pl);
-        pl_control(pl);
+        pl_death_check(ctx,pl);
+        pl_control(ctx,pl);
         pl_move(pl,tm);
     }
-    pl_animate(pl,tm);
-
-    pl->canMove = obj_can_move();
-}
-
+    pl_animate(ctx,pl,tm);
 
-// Draw player
-void pl_draw(PLAYER* pl)
-{
-    spr_draw(&pl->spr,bmpPlayer,(int)round(pl->vpos.x) - 4,(int)round(pl->vpos.y) -4 + 1,pl->dir);
+    pl->canMove = obj_can_move(ctx);
 }
 
 
 // Hurt player
-void pl_hurt(PLAYER* pl)
+void pl_hurt(GAME_CONTEXT* ctx, PLAYER* pl)
 {
     pl->dying = true;
     pl->deathMode = 1;
     pl->jumping = false;
     pl->falling = false;
 
-    fade_out_music(500);
+    sim_emit(ctx,SIM_EVENT_DEATH,pl->x,pl->y);
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 #define __PLAYER__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -39,13 +38,10 @@ EXTENDS_GAME_OBJECT
 
 AS ( PLAYER );
 
-/// Initialize player
-/// < ass Assets
-void pl_init(ASSET_PACK* ass);
-
 /// Reset player
+/// < ctx Game context
 /// < pl Player to reset
-void pl_reset(PLAYER* pl);
+void pl_reset(GAME_CONTEXT* ctx, PLAYER* pl);
 
 /// Create a new player
 /// < x X coordinate (in grid)
@@ -54,16 +50,14 @@ void pl_reset(PLAYER* pl);
 PLAYER pl_create(int x, int y);
 
 /// Update player
+/// < ctx Game context
 /// < pl Player object
 /// < tm Time multiplier
-void pl_update(PLAYER* pl, float tm);
-
-/// Draw player
-/// < pl Player object
-void pl_draw(PLAYER* pl);
+void pl_update(GAME_CONTEXT* ctx, PLAYER* pl, float tm);
 
 /// Hurt player
+/// < ctx Game context
 /// < pl Player to hurt
-void pl_hurt(PLAYER* pl);
+void pl_hurt(GAME_CONTEXT* ctx, PLAYER* pl);
 
 #endif // __PLAYER__
\ No newline at end of file
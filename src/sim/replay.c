@@ -0,0 +1,398 @@
+/// Input replays (source)
+/// (c) 2018 Jani Nykänen
+
+#include "replay.h"
+
+#include "sim.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+#include "limits.h"
+
+// File header size
+#define HEADER_SIZE 40
+// Run fields
+#define FIELD_X 1
+#define FIELD_Y 2
+#define FIELD_BUTTONS 4
+
+// Magic number
+static const char MAGIC[4] = {'A','Q','R','P'};
+
+
+// Write a little-endian value
+static void put(unsigned char* p, unsigned long long v, int bytes)
+{
+    int i = 0;
+    for(; i < bytes; ++ i)
+    {
+        p[i] = (unsigned char)(v >> (i*8));
+    }
+}
+
+
+// Read a little-endian value
+static unsigned long long get(const unsigned char* p, int bytes)
+{
+    unsigned long long v = 0;
+    int i = 0;
+    for(; i < bytes; ++ i)
+    {
+        v |= (unsigned long long)p[i] << (i*8);
+    }
+    return v;
+}
+
+
+// Make room for more data in a buffer
+static int reserve(unsigned char** data, size_t size, size_t* capacity, size_t bytes)
+{
+    if(size + bytes <= *capacity) return 0;
+
+    size_t cap = *capacity == 0 ? 256 : *capacity * 2;
+    while(cap < size + bytes)
+        cap *= 2;
+
+    unsigned char* p = (unsigned char*)realloc(*data,cap);
+    if(p == NULL) return 1;
+
+    *data = p;
+    *capacity = cap;
+    return 0;
+}
+
+
+// Write a variable-length integer
+static unsigned char* put_varint(unsigned char* p, unsigned long v)
+{
+    do
+    {
+        *(p ++) = (unsigned char)((v & 0x7F) | (v > 0x7F ? 0x80 : 0));
+        v >>= 7;
+    }
+    while(v > 0);
+
+    return p;
+}
+
+
+// Read a variable-length integer, false if the data ends
+// or the value does not fit
+static bool get_varint(const unsigned char* data, size_t size, size_t* pos, long* v)
+{
+    unsigned long u = 0;
+    int shift = 0;
+    unsigned char b;
+
+    do
+    {
+        if(*pos >= size || shift >= (int)sizeof(unsigned long)*8) return false;
+
+        b = data[(*pos) ++];
+        u |= (unsigned long)(b & 0x7F) << shift;
+        shift += 7;
+    }
+    while(b & 0x80);
+
+    if(u > LONG_MAX) return false;
+
+    *v = (long)u;
+    return true;
+}
+
+
+// Write the pending run: the changed fields, then the
+// length as a variable-length integer
+static int flush(REPLAY* r)
+{
+    REPLAY_FRAME* f = &r->pending;
+    unsigned char* p;
+    unsigned char mask = 0;
+
+    if(r->pendingRun == 0) return 0;
+    if(reserve(&r->data,r->size,&r->capacity,16) != 0) return 1;
+
+    if(f->stickX != r->written.stickX) mask |= FIELD_X;
+    if(f->stickY != r->written.stickY) mask |= FIELD_Y;
+    if(f->buttons != r->written.buttons) mask |= FIELD_BUTTONS;
+
+    p = r->data + r->size;
+    *(p ++) = mask;
+    if(mask & FIELD_X) *(p ++) = (unsigned char)f->stickX;
+    if(mask & FIELD_Y) *(p ++) = (unsigned char)f->stickY;
+    if(mask & FIELD_BUTTONS)
+    {
+        put(p,f->buttons,2);
+        p += 2;
+    }
+    p = put_varint(p,(unsigned long)r->pendingRun);
+
+    r->size = p - r->data;
+    r->written = *f;
+    r->pendingRun = 0;
+
+    return 0;
+}
+
+
+// Get build hash
+unsigned int replay_build_hash()
+{
+    // Byte by byte so the hash is the same on any endianness
+    const unsigned int v = (SIM_RULES_VERSION << 16) | REPLAY_VERSION;
+    unsigned int h = 2166136261u;
+    int i = 0;
+    for(; i < 4; ++ i)
+    {
+        h = (h ^ ((v >> (i*8)) & 0xFF)) * 16777619u;
+    }
+    return h;
+}
+
+
+// Make frame
+REPLAY_FRAME replay_make_frame(VEC2 stick, const int* buttons)
+{
+    REPLAY_FRAME f;
+    int i = 0;
+
+    f.stickX = (signed char)round(fmin(fmax(stick.x,-1.0f),1.0f) * 127.0f);
+    f.stickY = (signed char)round(fmin(fmax(stick.y,-1.0f),1.0f) * 127.0f);
+    f.buttons = 0;
+    for(; i < REPLAY_BUTTONS; ++ i)
+    {
+        f.buttons |= (buttons[i] & 3) << (i*2);
+    }
+
+    return f;
+}
+
+
+// Get frame stick
+VEC2 replay_frame_stick(const REPLAY_FRAME* f)
+{
+    return vec2(f->stickX / 127.0f,f->stickY / 127.0f);
+}
+
+
+// Get frame button
+int replay_frame_button(const REPLAY_FRAME* f, int i)
+{
+    return (f->buttons >> (i*2)) & 3;
+}
+
+
+// Create
+REPLAY* replay_create(int stage, unsigned int seed)
+{
+    REPLAY* r = (REPLAY*)malloc(sizeof(REPLAY));
+    if(r == NULL) return NULL;
+    memset(r,0,sizeof(REPLAY));
+
+    r->stage = stage;
+    r->seed = seed;
+    r->build = replay_build_hash();
+
+    return r;
+}
+
+
+// Push
+int replay_push(REPLAY* r, const REPLAY_FRAME* f)
+{
+    if(r->pendingRun > 0 && memcmp(f,&r->pending,sizeof(REPLAY_FRAME)) != 0)
+    {
+        if(flush(r) != 0) return 1;
+    }
+    r->pending = *f;
+    ++ r->pendingRun;
+    ++ r->frameCount;
+
+    return 0;
+}
+
+
+// Trace
+int replay_trace(REPLAY* r, long tick, unsigned int hash)
+{
+    if(r->traceSize > 0 && hash == r->traceHash)
+        return 0;
+    if(reserve(&r->trace,r->traceSize,&r->traceCapacity,16) != 0)
+        return 1;
+
+    unsigned char* p = put_varint(r->trace + r->traceSize,(unsigned long)(tick - r->traceTick));
+    put(p,hash,4);
+    r->traceSize = (p+4) - r->trace;
+    r->traceTick = tick;
+    r->traceHash = hash;
+
+    return 0;
+}
+
+
+// Next trace
+bool replay_next_trace(REPLAY* r, long* tick, unsigned int* hash)
+{
+    long delta;
+
+    if(!get_varint(r->trace,r->traceSize,&r->tracePos,&delta)
+        || r->tracePos + 4 > r->traceSize)
+        return false;
+
+    r->readTick += delta;
+    *tick = r->readTick;
+    *hash = (unsigned int)get(r->trace + r->tracePos,4);
+    r->tracePos += 4;
+
+    return true;
+}
+
+
+// Finish
+void replay_finish(REPLAY* r, bool victory, int turns, unsigned long long hash)
+{
+    r->finished = true;
+    r->victory = victory;
+    r->turns = turns;
+    r->hash = hash;
+}
+
+
+// Save
+int replay_save(REPLAY* r, const char* path)
+{
+    unsigned char h[HEADER_SIZE];
+
+    if(flush(r) != 0) return 1;
+
+    FILE* f = fopen(path,"wb");
+    if(f == NULL) return 1;
+
+    memcpy(h,MAGIC,4);
+    put(h+4,REPLAY_VERSION,2);
+    put(h+6,r->stage,2);
+    put(h+8,r->seed,4);
+    put(h+12,r->build,4);
+    h[16] = (unsigned char)r->finished;
+    h[17] = (unsigned char)r->victory;
+    put(h+18,r->turns,2);
+    put(h+20,r->hash,8);
+    put(h+28,r->frameCount,4);
+    put(h+32,r->size,4);
+    put(h+36,r->traceSize,4);
+
+    bool ok = fwrite(h,1,HEADER_SIZE,f) == HEADER_SIZE
+        && fwrite(r->data,1,r->size,f) == r->size
+        && fwrite(r->trace,1,r->traceSize,f) == r->traceSize;
+    fclose(f);
+
+    return ok ? 0 : 1;
+}
+
+
+// Load
+REPLAY* replay_load(const char* path)
+{
+    unsigned char h[HEADER_SIZE];
+
+    FILE* f = fopen(path,"rb");
+    if(f == NULL) return NULL;
+
+    if(fread(h,1,HEADER_SIZE,f) != HEADER_SIZE || memcmp(h,MAGIC,4) != 0
+        || get(h+4,2) != REPLAY_VERSION)
+    {
+        fclose(f);
+        return NULL;
+    }
+
+    REPLAY* r = replay_create((int)get(h+6,2),(unsigned int)get(h+8,4));
+    if(r == NULL)
+    {
+        fclose(f);
+        return NULL;
+    }
+    r->build = (unsigned int)get(h+12,4);
+    r->finished = h[16] != 0;
+    r->victory = h[17] != 0;
+    r->turns = (int)get(h+18,2);
+    r->hash = get(h+20,8);
+    r->frameCount = (long)get(h+28,4);
+
+    size_t size = (size_t)get(h+32,4);
+    size_t traceSize = (size_t)get(h+36,4);
+    if(reserve(&r->data,0,&r->capacity,size) != 0
+        || reserve(&r->trace,0,&r->traceCapacity,traceSize) != 0
+        || fread(r->data,1,size,f) != size
+        || fread(r->trace,1,traceSize,f) != traceSize)
+    {
+        fclose(f);
+        replay_destroy(r);
+        return NULL;
+    }
+    r->size = size;
+    r->traceSize = traceSize;
+    fclose(f);
+
+    replay_rewind(r);
+    return r;
+}
+
+
+// Rewind
+void replay_rewind(REPLAY* r)
+{
+    flush(r);
+
+    r->readPos = 0;
+    r->run = 0;
+    r->tracePos = 0;
+    r->readTick = 0;
+    memset(&r->current,0,sizeof(REPLAY_FRAME));
+}
+
+
+// Next
+bool replay_next(REPLAY* r, REPLAY_FRAME* f)
+{
+    unsigned char mask;
+
+    // Read the next run
+    while(r->run == 0)
+    {
+        if(r->readPos >= r->size) return false;
+
+        // The changed fields must fit in the data
+        mask = r->data[r->readPos];
+        if(r->readPos + 1 + (mask & FIELD_X ? 1 : 0) + (mask & FIELD_Y ? 1 : 0)
+            + (mask & FIELD_BUTTONS ? 2 : 0) > r->size)
+            return false;
+        ++ r->readPos;
+        if(mask & FIELD_X) r->current.stickX = (signed char)r->data[r->readPos ++];
+        if(mask & FIELD_Y) r->current.stickY = (signed char)r->data[r->readPos ++];
+        if(mask & FIELD_BUTTONS)
+        {
+            r->current.buttons = (unsigned short)get(r->data + r->readPos,2);
+            r->readPos += 2;
+        }
+
+        if(!get_varint(r->data,r->size,&r->readPos,&r->run))
+            return false;
+    }
+
+    -- r->run;
+    *f = r->current;
+    return true;
+}
+
+
+// Destroy
+void replay_destroy(REPLAY* r)
+{
+    if(r == NULL) return;
+
+    free(r->data);
+    free(r->trace);
+    free(r);
+}
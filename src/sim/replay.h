@@ -0,0 +1,147 @@
+/// Input replays (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __REPLAY__
+#define __REPLAY__
+
+#include "../engine/vector.h"
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/// Recorded buttons
+#define REPLAY_BUTTONS 6
+/// File format version
+#define REPLAY_VERSION 1
+
+/// Input of one tick. The stick is stored in 1/127 steps,
+/// the buttons take 2 bits each
+typedef struct
+{
+    signed char stickX; /// Stick x
+    signed char stickY; /// Stick y
+    unsigned short buttons; /// Button states
+}
+REPLAY_FRAME;
+
+/// Replay. The frames are stored as runs of equal frames,
+/// each run holding only the fields that changed. The
+/// trace holds the ticks where the state hash changed, to
+/// find the tick where a playback diverges
+typedef struct
+{
+    int stage; /// Stage index
+    unsigned int seed; /// Random seed
+    unsigned int build; /// Hash of the rules it was recorded with
+
+    bool finished; /// Has the result been stored
+    bool victory; /// Did the stage end in a victory
+    int turns; /// Turn count in the end
+    unsigned long long hash; /// State hash in the end
+
+    long frameCount; /// Frames stored
+    unsigned char* data; /// Encoded frames
+    size_t size; /// Encoded size
+    size_t capacity; /// Data capacity
+
+    REPLAY_FRAME pending; /// Frame of the run being recorded
+    long pendingRun; /// Length of the run being recorded
+    REPLAY_FRAME written; /// Frame of the last written run
+
+    size_t readPos; /// Read position
+    REPLAY_FRAME current; /// Frame of the run being played
+    long run; /// Frames left in the run being played
+
+    unsigned char* trace; /// Encoded trace
+    size_t traceSize; /// Trace size
+    size_t traceCapacity; /// Trace capacity
+    long traceTick; /// Tick of the last trace entry
+    unsigned int traceHash; /// Hash of the last trace entry
+
+    size_t tracePos; /// Trace read position
+    long readTick; /// Tick of the last trace entry read
+}
+REPLAY;
+
+/// Get the hash identifying the rules & the format of this
+/// build. It only changes with SIM_RULES_VERSION or the
+/// format version, so every build of the same rules agrees
+/// > Hash
+unsigned int replay_build_hash();
+
+/// Make a frame
+/// < stick Stick position
+/// < buttons Button states, REPLAY_BUTTONS of them
+/// > Frame
+REPLAY_FRAME replay_make_frame(VEC2 stick, const int* buttons);
+
+/// Get the stick position of a frame
+/// < f Frame
+/// > Stick position
+VEC2 replay_frame_stick(const REPLAY_FRAME* f);
+
+/// Get a button state of a frame
+/// < f Frame
+/// < i Button index
+/// > Button state
+int replay_frame_button(const REPLAY_FRAME* f, int i);
+
+/// Create a replay for recording
+/// < stage Stage index
+/// < seed Random seed
+/// > A new replay, NULL on error
+REPLAY* replay_create(int stage, unsigned int seed);
+
+/// Add a frame
+/// < r Replay
+/// < f Frame
+/// > 0 on success, 1 on error
+int replay_push(REPLAY* r, const REPLAY_FRAME* f);
+
+/// Add a trace entry if the hash has changed
+/// < r Replay
+/// < tick Tick, counted from 1
+/// < hash State hash after the tick
+/// > 0 on success, 1 on error
+int replay_trace(REPLAY* r, long tick, unsigned int hash);
+
+/// Get the next trace entry
+/// < r Replay
+/// < tick Tick
+/// < hash State hash after the tick
+/// > False in the end of the trace
+bool replay_next_trace(REPLAY* r, long* tick, unsigned int* hash);
+
+/// Store the result
+/// < r Replay
+/// < victory Did the stage end in a victory
+/// < turns Turn count in the end
+/// < hash State hash in the end
+void replay_finish(REPLAY* r, bool victory, int turns, unsigned long long hash);
+
+/// Save a replay
+/// < r Replay
+/// < path File path
+/// > 0 on success, 1 on error
+int replay_save(REPLAY* r, const char* path);
+
+/// Load a replay, rewound for playback
+/// < path File path
+/// > A new replay, NULL on error
+REPLAY* replay_load(const char* path);
+
+/// Rewind for playback
+/// < r Replay
+void replay_rewind(REPLAY* r);
+
+/// Get the next frame
+/// < r Replay
+/// < f Frame
+/// > False in the end of the replay
+bool replay_next(REPLAY* r, REPLAY_FRAME* f);
+
+/// Destroy a replay
+/// < r Replay
+void replay_destroy(REPLAY* r);
+
+#endif // __REPLAY__
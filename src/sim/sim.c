@@ -0,0 +1,94 @@
+/// Simulation core (source)
+/// (c) 2018 Jani Nykänen
+
+#include "sim.h"
+
+#include "zobrist.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+
+// Initialize
+void sim_init(GAME_CONTEXT* ctx)
+{
+    memset(ctx,0,sizeof(GAME_CONTEXT));
+
+    ctx->obj.canMove = true;
+    ctx->input = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+}
+
+
+// Destroy
+void sim_destroy(GAME_CONTEXT* ctx)
+{
+    obj_clear(ctx);
+}
+
+
+// Set observer
+void sim_set_observer(GAME_CONTEXT* ctx, SIM_OBSERVER obs, void* data)
+{
+    ctx->observer = obs;
+    ctx->observerData = data;
+}
+
+
+// Emit event
+void sim_emit(GAME_CONTEXT* ctx, int type, int x, int y)
+{
+    if(ctx->observer == NULL) return;
+
+    SIM_EVENT ev = (SIM_EVENT){type,x,y};
+    ctx->observer(&ev,ctx->observerData);
+}
+
+
+// Get input
+const SIM_INPUT* sim_get_input(GAME_CONTEXT* ctx)
+{
+    return &ctx->input;
+}
+
+
+// Load a stage
+int sim_load(GAME_CONTEXT* ctx, TILEMAP* map)
+{
+    ctx->input = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    obj_clear(ctx);
+    stage_set_map(ctx,map);
+    if(stage_reset(ctx,false) != 0)
+        return 1;
+
+    sim_reset(ctx);
+    return 0;
+}
+
+
+// Reset
+void sim_reset(GAME_CONTEXT* ctx)
+{
+    ctx->input = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    stage_reset(ctx,true);
+    status_reset(ctx);
+    obj_reset(ctx);
+
+    zobrist_reset(ctx);
+}
+
+
+// Get hash
+unsigned long long sim_get_hash(GAME_CONTEXT* ctx)
+{
+    return ctx->hash;
+}
+
+
+// Advance one tick
+void sim_tick(GAME_CONTEXT* ctx, const SIM_INPUT* in, float tm)
+{
+    ctx->input = *in;
+    obj_update(ctx,tm);
+}
@@ -0,0 +1,132 @@
+/// Simulation core (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __SIM__
+#define __SIM__
+
+#include "../engine/vector.h"
+#include "../lib/tmxc.h"
+
+#include "stage.h"
+#include "objects.h"
+#include "status.h"
+
+#include "stdbool.h"
+
+/// Rules version. Bump it when a change to the simulation
+/// makes the same input play out differently, so the old
+/// replays are known to be from other rules
+#define SIM_RULES_VERSION 1
+
+/// Button states, same values as in controls.h
+enum
+{
+    SIM_BUTTON_UP = 0,
+    SIM_BUTTON_DOWN = 1,
+    SIM_BUTTON_PRESSED = 2,
+    SIM_BUTTON_RELEASED = 3,
+};
+
+/// Simulation events
+enum
+{
+    SIM_EVENT_JUMP = 0, /// Player jumped
+    SIM_EVENT_DEATH = 1, /// Player started dying
+    SIM_EVENT_DEATH_HIT = 2, /// Player death animation hit the ground
+    SIM_EVENT_DEATH_END = 3, /// Death animation finished, stage should reset
+    SIM_EVENT_PUSH = 4, /// Boulder pushed
+    SIM_EVENT_THWOMP = 5, /// Boulder landed
+    SIM_EVENT_TRANSFORM = 6, /// Boulder is turning to soil in lava
+    SIM_EVENT_KEY = 7, /// Key picked up
+    SIM_EVENT_LOCK = 8, /// Lock opened
+    SIM_EVENT_COIN = 9, /// Coin picked up
+    SIM_EVENT_VICTORY = 10, /// Star reached
+};
+
+/// Input of one tick
+typedef struct
+{
+    VEC2 stick; /// Stick axis
+    int jump; /// Jump button state
+}
+SIM_INPUT;
+
+/// Simulation event
+typedef struct
+{
+    int type; /// Event type
+    int x; /// Grid X coordinate
+    int y; /// Grid Y coordinate
+}
+SIM_EVENT;
+
+/// Event observer, presentation (drawing, audio, transitions)
+/// attaches to the simulation through this
+typedef void (*SIM_OBSERVER)(const SIM_EVENT* ev, void* data);
+
+/// Game context. Holds all the state of one game, so
+/// independent games can run side by side, even in
+/// different threads
+struct GAME_CONTEXT
+{
+    STAGE_STATE stage; /// Stage
+    OBJECT_LIST obj; /// Objects & the player
+    STATUS_STATE status; /// Keys, turns & victory
+
+    SIM_INPUT input; /// Input of the current tick
+    SIM_OBSERVER observer; /// Event observer
+    void* observerData; /// Observer user data
+
+    unsigned long long hash; /// Zobrist hash of the logical state
+};
+
+/// Initialize a game context
+/// < ctx Game context
+void sim_init(GAME_CONTEXT* ctx);
+
+/// Destroy the objects of a game context
+/// < ctx Game context
+void sim_destroy(GAME_CONTEXT* ctx);
+
+/// Set event observer
+/// < ctx Game context
+/// < obs Observer, NULL for none
+/// < data User data passed to the observer
+void sim_set_observer(GAME_CONTEXT* ctx, SIM_OBSERVER obs, void* data);
+
+/// Send an event to the observer
+/// < ctx Game context
+/// < type Event type
+/// < x Grid X coordinate
+/// < y Grid Y coordinate
+void sim_emit(GAME_CONTEXT* ctx, int type, int x, int y);
+
+/// Get the input of the current tick
+/// < ctx Game context
+/// > Input
+const SIM_INPUT* sim_get_input(GAME_CONTEXT* ctx);
+
+/// Load a stage & create its objects
+/// < ctx Game context
+/// < map Stage map
+/// > 0 on success, 1 on error
+int sim_load(GAME_CONTEXT* ctx, TILEMAP* map);
+
+/// Reset the stage to its starting state
+/// < ctx Game context
+void sim_reset(GAME_CONTEXT* ctx);
+
+/// Get the Zobrist hash of the logical state: tiles,
+/// collision, objects, the player, keys & electricity.
+/// It is kept up to date as the state changes
+/// < ctx Game context
+/// > Hash
+unsigned long long sim_get_hash(GAME_CONTEXT* ctx);
+
+/// Advance one tick
+/// < ctx Game context
+/// < in Input
+/// < tm Time mul.
+void sim_tick(GAME_CONTEXT* ctx, const SIM_INPUT* in, float tm);
+
+#endif // __SIM__
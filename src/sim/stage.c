@@ -0,0 +1,408 @@
+/// Stage (source)
+/// (c) 2018 Jani Nykänen
+
+#include "stage.h"
+
+#include "../lib/tmxc.h"
+
+#include "objects.h"
+#include "player.h"
+#include "sim.h"
+#include "zobrist.h"
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+
+
+// Get the planes of a tile ID
+static int tile_planes(int id)
+{
+    switch(id)
+    {
+    case 1: case 5: return 1 << STAGE_PLANE_MUTABLE;
+    case 2: return (1 << STAGE_PLANE_VINE) | (1 << STAGE_PLANE_MUTABLE);
+    case 3: return 1 << STAGE_PLANE_LAVA;
+    case 17: case 21: return 1 << STAGE_PLANE_PURPLE;
+    case 18: return (1 << STAGE_PLANE_PURPLE) | (1 << STAGE_PLANE_MUTABLE);
+    case 20: return (1 << STAGE_PLANE_PURPLE) | (1 << STAGE_PLANE_LAVA);
+    case 22: return (1 << STAGE_PLANE_ELEC_ON) | (1 << STAGE_PLANE_ELEC_JUMP)
+        | (1 << STAGE_PLANE_MUTABLE);
+    case 23: return 1 << STAGE_PLANE_ELEC_ON;
+    case 24: return (1 << STAGE_PLANE_ELEC_OFF) | (1 << STAGE_PLANE_ELEC_JUMP);
+    case 25: return 1 << STAGE_PLANE_ELEC_OFF;
+    default: return 0;
+    }
+}
+
+
+// Get the planes of a collision ID
+static int col_planes(int id)
+{
+    if(id == 4)
+        return (1 << STAGE_PLANE_SOLID) | (1 << STAGE_PLANE_SPIKES);
+    if(id == 1 || id == 5 || id == 6 || id == 17 || id == 21)
+        return 1 << STAGE_PLANE_SOLID;
+
+    return 0;
+}
+
+
+// Set the bits of a tile, one for each plane in the mask
+static void set_bits(GAME_CONTEXT* ctx, int i, int mask)
+{
+    unsigned long long bit = 1ull << (i & 63);
+    int w = i >> 6;
+    int p = 0;
+
+    for(; p < STAGE_PLANE_COUNT; ++ p)
+    {
+        if(mask & (1 << p))
+            ctx->stage.planes[p] [w] |= bit;
+        else
+            ctx->stage.planes[p] [w] &= ~bit;
+    }
+}
+
+
+// Test a bit
+static bool test_bit(GAME_CONTEXT* ctx, int plane, int i)
+{
+    return (ctx->stage.planes[plane] [i >> 6] >> (i & 63)) & 1;
+}
+
+
+// Is the point inside the map
+static bool is_inside(GAME_CONTEXT* ctx, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < ctx->stage.map->width && y < ctx->stage.map->height;
+}
+
+
+// Find the next set bit of a plane from i on, -1 if none
+static int next_bit(const unsigned long long* plane, int i)
+{
+    int w = i >> 6;
+    unsigned long long bits;
+
+    if(w >= STAGE_PLANE_WORDS) return -1;
+
+    bits = plane[w] & (~0ull << (i & 63));
+    while(bits == 0)
+    {
+        if(++ w >= STAGE_PLANE_WORDS) return -1;
+        bits = plane[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+}
+
+
+// Parse map and create objects and define collision map
+static int parse_map(GAME_CONTEXT* ctx, TILEMAP* t, bool colOnly)
+{
+    int i = 0;
+    int id = 0;
+
+    // Collision tiles
+    for(; i < t->tcount; ++ i)
+    {
+        id = ctx->stage.layerData[i];
+        if(id > 0 && (colOnly || !stage_is_spawn_tile(id)))
+        {
+            ctx->stage.colMap[i] = id;
+        }
+    }
+    stage_rebuild_planes(ctx);
+    if(colOnly) return 0;
+
+    // Spawn objects, the list is pre-extracted by the map cache
+    if(t->spawns == NULL && tmx_extract_spawns(t,0,stage_is_spawn_tile) != 0)
+        return 1;
+
+    for(i = 0; i < t->spawnCount; ++ i)
+    {
+        obj_reserve(ctx,t->spawns[i].id);
+    }
+    if(obj_alloc(ctx) != 0)
+        return 1;
+
+    for(i = 0; i < t->spawnCount; ++ i)
+    {
+        if(obj_add(ctx,t->spawns[i].id,t->spawns[i].x,t->spawns[i].y) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+// Set the tile & the collision value of a cell, keeping
+// the hash up to date
+static void set_cell(GAME_CONTEXT* ctx, int i, int tile, int col)
+{
+    zobrist_change(ctx,ZOBRIST_TILE,i,ctx->stage.layerData[i],tile);
+    zobrist_change(ctx,ZOBRIST_COLLISION,i,ctx->stage.colMap[i],col);
+
+    ctx->stage.layerData[i] = tile;
+    ctx->stage.colMap[i] = col;
+    set_bits(ctx,i,tile_planes(tile) | col_planes(col));
+}
+
+
+// Reset stage
+int stage_reset(GAME_CONTEXT* ctx, bool soft)
+{
+    // Set variables to their default values
+    ctx->stage.elecOn = true;
+
+    if(ctx->stage.map == NULL) return 0;
+    if(ctx->stage.map->width*ctx->stage.map->height > STAGE_MAX_TILES)
+        return 1;
+
+    // Clear collision map & copy layer data
+    int i = 0;
+    for(; i < ctx->stage.map->width*ctx->stage.map->height; ++ i)
+    {
+        ctx->stage.layerData[i] = ctx->stage.map->layers[0] [i];
+        ctx->stage.colMap[i] = 0;
+    }
+
+    // Create objects
+    return parse_map(ctx,ctx->stage.map,soft);
+}
+
+
+// Rebuild planes
+void stage_rebuild_planes(GAME_CONTEXT* ctx)
+{
+    int i = 0;
+    int tiles = ctx->stage.map->width*ctx->stage.map->height;
+
+    memset(ctx->stage.planes,0,sizeof(ctx->stage.planes));
+    for(; i < tiles; ++ i)
+    {
+        set_bits(ctx,i,tile_planes(ctx->stage.layerData[i])
+            | col_planes(ctx->stage.colMap[i]));
+    }
+}
+
+
+// Is there electricity harmful right now in the cell,
+// of the given kind
+static bool is_elec(GAME_CONTEXT* ctx, int x, int y, bool jump)
+{
+    if(!is_inside(ctx,x,y)) return false;
+
+    int i = y * ctx->stage.map->width + x;
+    return test_bit(ctx,ctx->stage.elecOn ? STAGE_PLANE_ELEC_ON : STAGE_PLANE_ELEC_OFF,i)
+        && test_bit(ctx,STAGE_PLANE_ELEC_JUMP,i) == jump;
+}
+
+
+// Player electricity collision
+void stage_player_elec_collision(GAME_CONTEXT* ctx, void* p)
+{
+    PLAYER* pl = (PLAYER*)p;
+    int y;
+
+    // Jumped over, the cell between the old & the new position
+    if(pl->jumping && abs(pl->x - pl->oldPos.x) == 2
+        && is_elec(ctx,(pl->x + pl->oldPos.x) / 2,pl->y,true)
+        && !stage_is_harmful(ctx,pl->oldPos.x,pl->oldPos.y))
+    {
+        pl_hurt(ctx,pl);
+    }
+
+    // Falling through, the cell the player is inside of
+    y = (int)floorf(pl->vpos.y / 16.0f);
+    if(pl->falling && pl->vpos.y > y*16.0f && is_elec(ctx,pl->x,y,false))
+    {
+        pl_hurt(ctx,pl);
+    }
+}
+
+
+// Get collision map
+int* stage_get_collision_map(GAME_CONTEXT* ctx)
+{
+    return ctx->stage.colMap;
+}
+
+
+// Get current map dimensions
+POINT stage_get_map_size(GAME_CONTEXT* ctx)
+{
+    return point(ctx->stage.map->width,ctx->stage.map->height);
+}
+
+
+// Get tile
+int stage_get_tile(GAME_CONTEXT* ctx, int x, int y)
+{
+    if(x < 0 || y < 0 || x >= ctx->stage.map->width || y >= ctx->stage.map->height)
+        return -1;
+
+    return ctx->stage.layerData[y * ctx->stage.map->width + x];
+}
+
+
+// Is the electricity on
+bool stage_is_electricity_on(GAME_CONTEXT* ctx)
+{
+    return ctx->stage.elecOn;
+}
+
+
+// Is the tile ID an object spawn tile
+bool stage_is_spawn_tile(int id)
+{
+    return (id >= 6  && id < 16) || id == 19 || id == 26;
+}
+
+
+// Is the tile in x,y solid
+bool stage_is_solid(GAME_CONTEXT* ctx, int x, int y)
+{
+    if(!is_inside(ctx,x,y))
+        return true;
+
+    return test_bit(ctx,STAGE_PLANE_SOLID,y * ctx->stage.map->width + x);
+}
+
+
+// Is the tile in x,y vine
+bool stage_is_vine(GAME_CONTEXT* ctx, int x, int y)
+{
+    if(!is_inside(ctx,x,y))
+        return false;
+
+    return test_bit(ctx,STAGE_PLANE_VINE,y * ctx->stage.map->width + x);
+}
+
+
+// Set collision tile value
+void stage_set_collision_tile(GAME_CONTEXT* ctx, int x, int y, int id)
+{
+    if(!is_inside(ctx,x,y))
+        return;
+
+    int i = y * ctx->stage.map->width + x;
+    set_cell(ctx,i,ctx->stage.layerData[i],id);
+}
+
+
+// Set tile
+void stage_set_tile(GAME_CONTEXT* ctx, int x, int y, int id)
+{
+    int i = y*ctx->stage.map->width + x;
+    set_cell(ctx,i,id,ctx->stage.colMap[i]);
+}
+
+
+// Is lava
+bool stage_is_lava(GAME_CONTEXT* ctx, int x, int y)
+{
+    if(!is_inside(ctx,x,y))
+        return false;
+
+    return test_bit(ctx,STAGE_PLANE_LAVA,y * ctx->stage.map->width + x);
+}
+
+
+// Is harmful
+int stage_is_harmful(GAME_CONTEXT* ctx, int x, int y)
+{
+    if(!is_inside(ctx,x,y))
+        return false;
+
+    int i = y * ctx->stage.map->width + x;
+
+    // Spikes below
+    if(y+1 < ctx->stage.map->height
+        && test_bit(ctx,STAGE_PLANE_SPIKES,i + ctx->stage.map->width))
+        return 1;
+
+    if(test_bit(ctx,STAGE_PLANE_LAVA,i)
+        || test_bit(ctx,ctx->stage.elecOn ? STAGE_PLANE_ELEC_ON : STAGE_PLANE_ELEC_OFF,i))
+        return 2;
+
+    return 0;
+}
+
+
+// Set stage map
+void stage_set_map(GAME_CONTEXT* ctx, TILEMAP* map)
+{
+    ctx->stage.map = map;
+}
+
+
+// Get stage map
+TILEMAP* stage_get_map(GAME_CONTEXT* ctx)
+{
+    return ctx->stage.map;
+}
+
+
+// Is the map the current stage
+bool stage_is_main_map(GAME_CONTEXT* ctx, void* map)
+{
+    return ctx->stage.map != NULL && map == (void*)ctx->stage.map;
+}
+
+
+/// Toggle purple blocks
+void stage_toggle_purple_blocks(GAME_CONTEXT* ctx)
+{
+    const unsigned long long* plane = ctx->stage.planes[STAGE_PLANE_PURPLE];
+
+    int i = next_bit(plane,0);
+    int id = 0;
+    for(; i >= 0; i = next_bit(plane,i+1))
+    {
+        id = ctx->stage.layerData[i];
+        if(id == 18)
+            set_cell(ctx,i,17,1);
+        else if(id == 17)
+            set_cell(ctx,i,18,0);
+        else if(id == 20)
+            set_cell(ctx,i,21,1);
+        else if(id == 21)
+            set_cell(ctx,i,20,0);
+    }
+}
+
+
+// Toggle electricity
+void stage_toggle_electricity(GAME_CONTEXT* ctx)
+{
+    zobrist_change(ctx,ZOBRIST_ELECTRICITY,0,ctx->stage.elecOn,!ctx->stage.elecOn);
+    ctx->stage.elecOn = !ctx->stage.elecOn;
+}
+
+
+// Mutate the stage
+void stage_mutate(GAME_CONTEXT* ctx)
+{
+    // The mutable plane changes while walking it, so walk a copy
+    unsigned long long plane[STAGE_PLANE_WORDS];
+    memcpy(plane,ctx->stage.planes[STAGE_PLANE_MUTABLE],sizeof(plane));
+
+    int i = next_bit(plane,0);
+    int id = 0;
+    int col;
+    for(; i >= 0; i = next_bit(plane,i+1))
+    {
+        id = ctx->stage.layerData[i];
+        col = ctx->stage.colMap[i];
+        switch(id)
+        {
+        case 1: set_cell(ctx,i,5,col); break;
+        case 5: set_cell(ctx,i,17,col); break;
+        case 18: set_cell(ctx,i,1,1); break;
+        case 2: set_cell(ctx,i,22,col); break;
+        case 22: set_cell(ctx,i,2,col); break;
+        default: break;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+/// Stage (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __STAGE__
+#define __STAGE__
+
+#include "../engine/vector.h"
+#include "../lib/tmxc.h"
+
+#include "obase.h"
+
+#include "stdbool.h"
+
+/// Maximum map size in tiles
+#define STAGE_MAX_TILES (16*12)
+/// Words in a bitboard plane, padded to 256 bits
+#define STAGE_PLANE_WORDS 4
+
+/// Bitboard planes, one bit per tile
+enum
+{
+    STAGE_PLANE_SOLID = 0, /// Solid collision
+    STAGE_PLANE_SPIKES = 1, /// Spike collision
+    STAGE_PLANE_VINE = 2, /// Vines
+    STAGE_PLANE_LAVA = 3, /// Lava
+    STAGE_PLANE_PURPLE = 4, /// Purple blocks, either state
+    STAGE_PLANE_ELEC_ON = 5, /// Electricity harmful when on
+    STAGE_PLANE_ELEC_OFF = 6, /// Electricity harmful when off
+    STAGE_PLANE_MUTABLE = 7, /// Tiles changed by a mutation
+    STAGE_PLANE_ELEC_JUMP = 8, /// Electricity hurting when jumped over, the rest when fallen through
+    STAGE_PLANE_COUNT = 9,
+};
+
+/// Stage state
+typedef struct
+{
+    TILEMAP* map; /// Stage map
+    int colMap[STAGE_MAX_TILES]; /// Collision map
+    int layerData[STAGE_MAX_TILES]; /// Layer data
+    unsigned long long planes[STAGE_PLANE_COUNT] [STAGE_PLANE_WORDS]; /// Bitboards of the above
+    bool elecOn; /// Is electricity on
+}
+STAGE_STATE;
+
+/// Reset stage
+/// < ctx Game context
+/// < soft Is a soft reset (objects are not created)
+/// > 0 on success, 1 on error
+int stage_reset(GAME_CONTEXT* ctx, bool soft);
+
+/// Rebuild the bitboard planes, needed after the tile or
+/// the collision arrays are written directly
+/// < ctx Game context
+void stage_rebuild_planes(GAME_CONTEXT* ctx);
+
+/// Player electricity collision, special cases. Only the
+/// cells between the old & the new player position are
+/// looked at
+/// < ctx Game context
+/// < p Player
+void stage_player_elec_collision(GAME_CONTEXT* ctx, void* p);
+
+/// Get collision map
+/// < ctx Game context
+/// > Collision map
+int* stage_get_collision_map(GAME_CONTEXT* ctx);
+
+/// Get current map dimensions
+/// < ctx Game context
+/// > Dimensions
+POINT stage_get_map_size(GAME_CONTEXT* ctx);
+
+/// Get tile value
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// > Tile ID, -1 if outside the map
+int stage_get_tile(GAME_CONTEXT* ctx, int x, int y);
+
+/// Is the electricity on
+/// < ctx Game context
+/// > True or false
+bool stage_is_electricity_on(GAME_CONTEXT* ctx);
+
+/// Is the tile ID an object spawn tile
+/// < id Tile ID
+/// > True or false
+bool stage_is_spawn_tile(int id);
+
+/// Is the tile in x,y solid
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// > True or false
+bool stage_is_solid(GAME_CONTEXT* ctx, int x, int y);
+
+/// Is the tile in x,y vine
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// > True or false
+bool stage_is_vine(GAME_CONTEXT* ctx, int x, int y);
+
+/// Set collision tile value
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// < id Tile ID
+void stage_set_collision_tile(GAME_CONTEXT* ctx, int x, int y, int id);
+
+/// Set tile value
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// < id Tile ID
+void stage_set_tile(GAME_CONTEXT* ctx, int x, int y, int id);
+
+/// Is the tile in x,y lava
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// > True or false
+bool stage_is_lava(GAME_CONTEXT* ctx, int x, int y);
+
+/// Is the tile harmful
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// > True or false
+int stage_is_harmful(GAME_CONTEXT* ctx, int x, int y);
+
+/// Set main stage map
+/// < ctx Game context
+/// < map Tilemap
+void stage_set_map(GAME_CONTEXT* ctx, TILEMAP* map);
+
+/// Get main stage map
+/// < ctx Game context
+/// > Tilemap
+TILEMAP* stage_get_map(GAME_CONTEXT* ctx);
+
+/// Is the map the current stage
+/// < ctx Game context
+/// < map Tilemap
+/// > True or false
+bool stage_is_main_map(GAME_CONTEXT* ctx, void* map);
+
+/// Toggle purple blocks
+/// < ctx Game context
+void stage_toggle_purple_blocks(GAME_CONTEXT* ctx);
+
+/// Toggle electricity
+/// < ctx Game context
+void stage_toggle_electricity(GAME_CONTEXT* ctx);
+
+/// Mutate the stage
+/// < ctx Game context
+void stage_mutate(GAME_CONTEXT* ctx);
+
+#endif // __STAGE__
\ No newline at end of file
@@ -3,8 +3,6 @@
 
 #include "star.h"
 
-#include "../engine/graphics.h"
-
 #include "player.h"
 #include "status.h"
 
@@ -12,12 +10,9 @@
 #include "stdlib.h"
 #include "math.h"
 
-// Star bitmap
-static BITMAP* bmpStar;
-
 
 // Player collision
-static void star_player_collision(void * o, void * p)
+static void star_player_collision(GAME_CONTEXT* ctx, void * o, void * p)
 {
     
     STAR* s = (STAR*)o;
@@ -36,14 +31,14 @@ static void star_player_collision(void * o, void * p)
         pl->vpos.x = pl->x*16.0f;
         pl->vpos.y = pl->y*16.0f;
 
-        status_activate_victory();
+        status_activate_victory(ctx);
 
     }
 }
 
 
 // Update Star
-static void star_update(void* o, float tm)
+static void star_update(GAME_CONTEXT* ctx, void* o, float tm)
 {
     STAR* s = (STAR*)o;
     if(!s->exist) return;
@@ -54,48 +49,28 @@ static void star_update(void* o, float tm)
         s->floatTimer -= 2 * M_PI;
 
     // Animate
-    spr_animate(&s->spr,status_star_type(),11,0,4,tm);
-}
-
-
-// Draw Star
-static void star_draw(void* o)
-{
-    STAR* s = (STAR*)o;
-
-    spr_draw(&s->spr,bmpStar,
-        (int)round(s->vpos.x),(int)round(s->vpos.y + cos(s->floatTimer)),0);
+    spr_animate(&s->spr,status_star_type(ctx),11,0,4,tm);
 }
 
 
 // Reset star
-static void star_reset(void* o)
+static void star_reset(GAME_CONTEXT* ctx, void* o)
 {
     STAR* s = (STAR*)o;
     s->collected = false;
     s->floatTimer = 0.0f;
 }
 
-// Initialize
-void star_init(ASSET_PACK* ass)
-{
-    bmpStar = (BITMAP*)get_asset(ass,"star");
-}
-
-
 // Create a new Star
 STAR star_create(int x, int y)
 {
     STAR s;
 
+    s.type = OBJ_STAR;
     s.x = x;
     s.y = y;
     s.vpos = vec2(x*16.0f,y*16.0f);
     s.spr = create_sprite(16,16);
-    s.onDraw = star_draw;
-    s.onUpdate = star_update;
-    s.onPlayerCollision = star_player_collision;
-    s.onReset = star_reset;
     s.preventMovement = false;
     s.exist = true;
     s.collected = false;
@@ -104,3 +79,10 @@ STAR star_create(int x, int y)
 
     return s;
 }
+
+
+// Get the type functions
+OBJECT_VTABLE star_get_vtable()
+{
+    return (OBJECT_VTABLE){star_update,star_player_collision,star_reset,true};
+}
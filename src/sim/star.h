@@ -5,7 +5,6 @@
 #define __STAR__
 
 #include "../engine/sprite.h"
-#include "../engine/assets.h"
 
 #include "obase.h"
 
@@ -18,14 +17,14 @@ EXTENDS_GAME_OBJECT
 
 AS ( STAR );
 
-/// Initialize stars
-/// < ass Assets
-void star_init(ASSET_PACK* ass);
-
 /// Create a new star
 /// < x X coordinate (in grid)
 /// < y Y coordinate (in grid)
 /// > A new star
 STAR star_create(int x, int y);
 
+/// Get the type functions of stars
+/// > Type functions
+OBJECT_VTABLE star_get_vtable();
+
 #endif // __STAR__
\ No newline at end of file
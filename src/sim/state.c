@@ -0,0 +1,142 @@
+/// Packed game state (source)
+/// (c) 2018 Jani Nykänen
+
+#include "state.h"
+
+#include "sim.h"
+#include "enemy.h"
+#include "key.h"
+#include "zobrist.h"
+
+#include "string.h"
+
+// Bytes per object: x, y, exist & direction
+#define OBJ_BYTES 4
+// Bytes of the player, keys & electricity
+#define MISC_BYTES 5
+
+
+// Get size
+int state_get_size(GAME_CONTEXT* ctx)
+{
+    POINT dim = stage_get_map_size(ctx);
+
+    return dim.x*dim.y*2 + obj_get_count(ctx)*OBJ_BYTES + MISC_BYTES;
+}
+
+
+// Pack
+void state_pack(GAME_CONTEXT* ctx, unsigned char* out)
+{
+    POINT dim = stage_get_map_size(ctx);
+    PLAYER* pl = obj_get_player(ctx);
+    OBJECT* o;
+    int tiles = dim.x*dim.y;
+    int i = 0;
+
+    // Tiles & collision, every ID fits in a byte
+    for(; i < tiles; ++ i)
+    {
+        *(out ++) = (unsigned char)ctx->stage.layerData[i];
+        *(out ++) = (unsigned char)ctx->stage.colMap[i];
+    }
+
+    // Objects
+    for(i = 0; i < obj_get_count(ctx); ++ i)
+    {
+        o = obj_get(ctx,i);
+        *(out ++) = (unsigned char)o->x;
+        *(out ++) = (unsigned char)o->y;
+        *(out ++) = (unsigned char)o->exist;
+        *(out ++) = o->type == OBJ_ENEMY ? (unsigned char)(((ENEMY*)o)->dir +1) : 0;
+    }
+
+    // Player, keys & electricity
+    *(out ++) = (unsigned char)pl->x;
+    *(out ++) = (unsigned char)pl->y;
+    *(out ++) = (unsigned char)pl->dir;
+    *(out ++) = (unsigned char)status_get_key_count(ctx);
+    *(out ++) = (unsigned char)stage_is_electricity_on(ctx);
+}
+
+
+// Place object
+void state_place_object(GAME_CONTEXT* ctx, OBJECT* o, int x, int y, bool exist, int dir)
+{
+    // Reset first to clear the animation state
+    obj_reset_object(ctx,o);
+
+    o->x = x;
+    o->y = y;
+    o->exist = exist;
+    o->vpos = vec2(o->x*16.0f,o->y*16.0f);
+    o->preventMovement = false;
+
+    if(o->type == OBJ_ENEMY)
+    {
+        ((ENEMY*)o)->dir = dir;
+        ((ENEMY*)o)->falling = false;
+        ((ENEMY*)o)->gravity = 0.0f;
+    }
+    else if(o->type == OBJ_KEY)
+    {
+        ((KEY*)o)->speedMul = 0.0f;
+    }
+}
+
+
+// Place player
+void state_place_player(GAME_CONTEXT* ctx, int x, int y, int dir)
+{
+    PLAYER* pl = obj_get_player(ctx);
+
+    pl_reset(ctx,pl);
+    pl->x = x;
+    pl->y = y;
+    pl->vpos = vec2(pl->x*16.0f,pl->y*16.0f);
+    pl->target = pl->vpos;
+    pl->dir = dir;
+    pl->falling = false;
+    pl->checkGravity = false;
+    pl->gravity = 0.0f;
+}
+
+
+// Unpack
+void state_unpack(GAME_CONTEXT* ctx, const unsigned char* in)
+{
+    POINT dim = stage_get_map_size(ctx);
+    int tiles = dim.x*dim.y;
+    int i = 0;
+
+    // Objects
+    const unsigned char* p = in + tiles*2;
+    for(; i < obj_get_count(ctx); ++ i, p += OBJ_BYTES)
+    {
+        state_place_object(ctx,obj_get(ctx,i),p[0],p[1],p[2] != 0,(int)p[3] -1);
+    }
+    obj_sync_index(ctx);
+
+    // Player
+    state_place_player(ctx,p[0],p[1],p[2]);
+
+    // Status
+    ctx->status.keyCount = p[3];
+    ctx->status.turnCount = 0;
+    ctx->status.victory = false;
+    ctx->stage.elecOn = p[4] != 0;
+
+    // Tiles & collision, last since resetting the objects
+    // writes to the collision map
+    for(i = 0; i < tiles; ++ i)
+    {
+        ctx->stage.layerData[i] = *(in ++);
+        ctx->stage.colMap[i] = *(in ++);
+    }
+    stage_rebuild_planes(ctx);
+
+    ctx->obj.canMove = true;
+    ctx->input = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    zobrist_reset(ctx);
+}
@@ -0,0 +1,50 @@
+/// Packed game state (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __STATE__
+#define __STATE__
+
+#include "obase.h"
+
+#include "stdbool.h"
+
+/// Get the size of a packed state of the loaded stage.
+/// Only the settled, logical state is packed: tiles,
+/// collision, object & player positions, the player
+/// direction, keys and electricity. Animation & the
+/// turn count are not
+/// < ctx Game context
+/// > Size in bytes
+int state_get_size(GAME_CONTEXT* ctx);
+
+/// Pack a settled state
+/// < ctx Game context
+/// < out Output, state_get_size bytes
+void state_pack(GAME_CONTEXT* ctx, unsigned char* out);
+
+/// Unpack a state. The context must have the same stage
+/// loaded. The objects are put to rest & the turn count
+/// is set to zero
+/// < ctx Game context
+/// < in Packed state
+void state_unpack(GAME_CONTEXT* ctx, const unsigned char* in);
+
+/// Put an object to rest in a cell. Resetting the object
+/// may write to the collision map in its start position,
+/// so the collision map must be restored afterwards
+/// < ctx Game context
+/// < o Object
+/// < x X coordinate
+/// < y Y coordinate
+/// < exist Does the object exist
+/// < dir Enemy direction, ignored by other objects
+void state_place_object(GAME_CONTEXT* ctx, OBJECT* o, int x, int y, bool exist, int dir);
+
+/// Put the player to rest in a cell
+/// < ctx Game context
+/// < x X coordinate
+/// < y Y coordinate
+/// < dir Direction
+void state_place_player(GAME_CONTEXT* ctx, int x, int y, int dir);
+
+#endif // __STATE__
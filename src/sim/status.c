@@ -0,0 +1,95 @@
+/// Status (source)
+/// (c) 2018 Jani Nykänen
+
+#include "status.h"
+
+#include "sim.h"
+#include "stage.h"
+#include "zobrist.h"
+
+
+// Reset status
+void status_reset(GAME_CONTEXT* ctx)
+{
+    zobrist_change(ctx,ZOBRIST_KEYS,0,ctx->status.keyCount,0);
+    ctx->status.keyCount = 0;
+    ctx->status.turnCount = 0;
+    ctx->status.victory = false;
+}
+
+
+// Add key
+void status_add_key(GAME_CONTEXT* ctx)
+{
+    zobrist_change(ctx,ZOBRIST_KEYS,0,ctx->status.keyCount,ctx->status.keyCount+1);
+    ++ ctx->status.keyCount;
+}
+
+
+// Remove key
+void status_remove_key(GAME_CONTEXT* ctx)
+{
+    if(ctx->status.keyCount > 0)
+    {
+        zobrist_change(ctx,ZOBRIST_KEYS,0,ctx->status.keyCount,ctx->status.keyCount-1);
+        -- ctx->status.keyCount;
+    }
+}
+
+
+// Get key count
+int status_get_key_count(GAME_CONTEXT* ctx)
+{
+    return ctx->status.keyCount;
+}
+
+
+// Add turn
+void status_add_turn(GAME_CONTEXT* ctx)
+{
+    ++ ctx->status.turnCount;
+    stage_toggle_electricity(ctx);
+}
+
+
+// Get turn count
+int status_get_turn_count(GAME_CONTEXT* ctx)
+{
+    return ctx->status.turnCount;
+}
+
+
+// Set turn target
+void status_set_turn_target(GAME_CONTEXT* ctx, int target)
+{
+    ctx->status.turnTarget = target;
+}
+
+
+// Get turn target
+int status_get_turn_target(GAME_CONTEXT* ctx)
+{
+    return ctx->status.turnTarget;
+}
+
+
+// Activate
+void status_activate_victory(GAME_CONTEXT* ctx)
+{
+    ctx->status.victory = true;
+    sim_emit(ctx,SIM_EVENT_VICTORY,0,0);
+}
+
+
+// Is victory
+bool status_is_victory(GAME_CONTEXT* ctx)
+{
+    return ctx->status.victory;
+}
+
+
+// Get the start type
+int status_star_type(GAME_CONTEXT* ctx)
+{
+    return (ctx->status.turnCount <= ctx->status.turnTarget) ? 0 : 1;
+}
\ No newline at end of file
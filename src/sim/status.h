@@ -0,0 +1,70 @@
+/// Status (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __STATUS__
+#define __STATUS__
+
+#include "obase.h"
+
+#include "stdbool.h"
+
+/// Status state
+typedef struct
+{
+    int keyCount; /// Key count
+    int turnCount; /// Turn count
+    int turnTarget; /// Target turns
+    bool victory; /// Is victory reached
+}
+STATUS_STATE;
+
+/// Reset status
+/// < ctx Game context
+void status_reset(GAME_CONTEXT* ctx);
+
+/// Add key
+/// < ctx Game context
+void status_add_key(GAME_CONTEXT* ctx);
+
+/// Remove key
+/// < ctx Game context
+void status_remove_key(GAME_CONTEXT* ctx);
+
+/// Get amount of keys
+/// < ctx Game context
+/// > Key count
+int status_get_key_count(GAME_CONTEXT* ctx);
+
+/// Add turn
+/// < ctx Game context
+void status_add_turn(GAME_CONTEXT* ctx);
+
+/// Get amount of turns
+/// < ctx Game context
+/// > Turn count
+int status_get_turn_count(GAME_CONTEXT* ctx);
+
+/// Set turn target
+/// < ctx Game context
+/// < target New target
+void status_set_turn_target(GAME_CONTEXT* ctx, int target);
+
+/// Get turn target
+/// < ctx Game context
+/// > Turn target
+int status_get_turn_target(GAME_CONTEXT* ctx);
+
+/// Activate victory
+/// < ctx Game context
+void status_activate_victory(GAME_CONTEXT* ctx);
+
+/// Is the stage won
+/// < ctx Game context
+bool status_is_victory(GAME_CONTEXT* ctx);
+
+/// Get the start type
+/// < ctx Game context
+/// > 0, if golden, 1, if bronze
+int status_star_type(GAME_CONTEXT* ctx);
+
+#endif // __STATUS__
\ No newline at end of file
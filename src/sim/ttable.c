@@ -0,0 +1,110 @@
+/// Transposition table (source)
+/// (c) 2018 Jani Nykänen
+
+#include "ttable.h"
+
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+
+
+// Create
+TTABLE* tt_create(size_t bytes)
+{
+    size_t count = 1;
+    while(count * 2 * sizeof(TT_BUCKET) <= bytes)
+        count *= 2;
+
+    TTABLE* tt = (TTABLE*)malloc(sizeof(TTABLE));
+    if(tt == NULL) return NULL;
+
+    tt->mem = malloc(count * sizeof(TT_BUCKET) + TT_ALIGN);
+    if(tt->mem == NULL)
+    {
+        free(tt);
+        return NULL;
+    }
+
+    uintptr_t addr = (uintptr_t)tt->mem;
+    tt->buckets = (TT_BUCKET*)((unsigned char*)tt->mem + ((TT_ALIGN - addr % TT_ALIGN) % TT_ALIGN));
+    tt->mask = count-1;
+    tt_clear(tt);
+
+    return tt;
+}
+
+
+// Clear
+void tt_clear(TTABLE* tt)
+{
+    memset(tt->buckets,0,(tt->mask+1) * sizeof(TT_BUCKET));
+    tt->hits = 0;
+    tt->misses = 0;
+    tt->replaced = 0;
+}
+
+
+// Probe
+bool tt_probe(TTABLE* tt, unsigned long long hash, TT_ENTRY* out)
+{
+    TT_BUCKET* b = &tt->buckets[hash & tt->mask];
+    int i = 0;
+
+    for(; i < TT_BUCKET_SIZE; ++ i)
+    {
+        if(b->entries[i].hash == hash && hash != 0)
+        {
+            *out = b->entries[i];
+            ++ tt->hits;
+            return true;
+        }
+    }
+    ++ tt->misses;
+    return false;
+}
+
+
+// Store
+void tt_store(TTABLE* tt, unsigned long long hash, int value, int depth)
+{
+    TT_BUCKET* b = &tt->buckets[hash & tt->mask];
+    TT_ENTRY* e = &b->entries[0];
+    int i = 0;
+
+    for(; i < TT_BUCKET_SIZE; ++ i)
+    {
+        // Same state or an empty entry
+        if(b->entries[i].hash == hash || b->entries[i].hash == 0)
+        {
+            e = &b->entries[i];
+            break;
+        }
+        // Otherwise the lowest depth goes
+        if(b->entries[i].depth < e->depth)
+            e = &b->entries[i];
+    }
+
+    if(e->hash != 0 && e->hash != hash)
+        ++ tt->replaced;
+
+    e->hash = hash;
+    e->value = value;
+    e->depth = depth;
+}
+
+
+// Get size
+size_t tt_get_size(TTABLE* tt)
+{
+    return (tt->mask+1) * sizeof(TT_BUCKET);
+}
+
+
+// Destroy
+void tt_destroy(TTABLE* tt)
+{
+    if(tt == NULL) return;
+
+    free(tt->mem);
+    free(tt);
+}
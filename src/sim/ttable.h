@@ -0,0 +1,77 @@
+/// Transposition table (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __TTABLE__
+#define __TTABLE__
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/// Entries in a bucket, one bucket fills a cache line
+#define TT_BUCKET_SIZE 4
+/// Bucket alignment
+#define TT_ALIGN 64
+
+/// Table entry
+typedef struct
+{
+    unsigned long long hash; /// State hash, 0 if empty
+    int value; /// Stored value
+    int depth; /// Depth, the lowest is replaced first
+}
+TT_ENTRY;
+
+/// Bucket of entries
+typedef struct
+{
+    TT_ENTRY entries[TT_BUCKET_SIZE];
+}
+TT_BUCKET;
+
+/// Fixed-size transposition table
+typedef struct
+{
+    void* mem; /// Allocated memory
+    TT_BUCKET* buckets; /// Buckets, aligned to TT_ALIGN
+    unsigned long long mask; /// Bucket index mask
+    long hits; /// Successful probes
+    long misses; /// Failed probes
+    long replaced; /// Entries overwritten by another state
+}
+TTABLE;
+
+/// Create a transposition table
+/// < bytes Memory size, rounded down to a power of two
+/// > A new table, NULL on error
+TTABLE* tt_create(size_t bytes);
+
+/// Remove every entry
+/// < tt Table
+void tt_clear(TTABLE* tt);
+
+/// Find an entry
+/// < tt Table
+/// < hash State hash
+/// < out Found entry
+/// > True if found
+bool tt_probe(TTABLE* tt, unsigned long long hash, TT_ENTRY* out);
+
+/// Store an entry. An entry of the same state is updated,
+/// otherwise an empty entry or the one with the lowest
+/// depth in the bucket is replaced
+/// < tt Table
+/// < hash State hash
+/// < value Value
+/// < depth Depth
+void tt_store(TTABLE* tt, unsigned long long hash, int value, int depth);
+
+/// Get the memory size of the entries
+/// < tt Table
+/// > Size in bytes
+size_t tt_get_size(TTABLE* tt);
+
+/// Destroy a transposition table
+/// < tt Table
+void tt_destroy(TTABLE* tt);
+
+#endif // __TTABLE__
@@ -0,0 +1,193 @@
+/// Turn resolution (source)
+/// (c) 2018 Jani Nykänen
+
+#include "turn.h"
+
+#include "sim.h"
+#include "boulder.h"
+#include "enemy.h"
+#include "coin.h"
+
+#include "stdlib.h"
+
+// Fixed time step
+static const float TURN_TM = 1.0f;
+
+// Move names
+static const char* MOVE_NAMES[] = {
+    "left", "right", "up", "down", "jump-left", "jump-right"
+};
+
+
+// Count events instead of playing them
+static void count_event(const SIM_EVENT* ev, void* data)
+{
+    ++ *((int*)data);
+}
+
+
+// Is the object still moving or animating something
+// the rules wait for
+static bool is_busy(OBJECT* o)
+{
+    if(!o->exist) return false;
+    if(o->preventMovement) return true;
+
+    if(o->type == OBJ_BOULDER)
+        return ((BOULDER*)o)->moving;
+    else if(o->type == OBJ_ENEMY)
+        return ((ENEMY*)o)->moving;
+    // A collected coin lets the player move, but it must
+    // be gone before the state is packed
+    else if(o->type == OBJ_COIN)
+        return ((COIN*)o)->dying;
+
+    return false;
+}
+
+
+// Has the turn ended in death or victory
+static int get_end(GAME_CONTEXT* ctx)
+{
+    if(status_is_victory(ctx)) return TURN_WON;
+    if(obj_get_player(ctx)->dying) return TURN_DEAD;
+
+    return -1;
+}
+
+
+// Tick with no input until settled
+static int run_until_settled(GAME_CONTEXT* ctx)
+{
+    const SIM_INPUT NEUTRAL = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    int i = 0;
+    int end;
+    for(; i < TURN_MAX_TICKS; ++ i)
+    {
+        sim_tick(ctx,&NEUTRAL,TURN_TM);
+
+        end = get_end(ctx);
+        if(end >= 0) return end;
+
+        if(turn_is_settled(ctx))
+            return TURN_MOVED;
+    }
+
+    return TURN_STUCK;
+}
+
+
+// Is settled
+bool turn_is_settled(GAME_CONTEXT* ctx)
+{
+    PLAYER* pl = obj_get_player(ctx);
+    int i = 0;
+
+    if(pl->moving || pl->jumping || pl->bouncing || pl->checkGravity)
+        return false;
+
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        if(is_busy(obj_get(ctx,i)))
+            return false;
+    }
+
+    return true;
+}
+
+
+// Settle
+int turn_settle(GAME_CONTEXT* ctx)
+{
+    SIM_OBSERVER obs = ctx->observer;
+    void* data = ctx->observerData;
+    int events = 0;
+
+    sim_set_observer(ctx,count_event,&events);
+    int ret = run_until_settled(ctx);
+    sim_set_observer(ctx,obs,data);
+
+    return ret;
+}
+
+
+// Get script
+int turn_get_script(GAME_CONTEXT* ctx, int move, SIM_INPUT* script)
+{
+    PLAYER* pl = obj_get_player(ctx);
+    int len = 0;
+
+    switch(move)
+    {
+    case MOVE_LEFT:
+    case MOVE_RIGHT:
+        script[len ++] = (SIM_INPUT){vec2(move == MOVE_LEFT ? -1.0f : 1.0f,0),SIM_BUTTON_UP};
+        break;
+
+    case MOVE_UP:
+    case MOVE_DOWN:
+        script[len ++] = (SIM_INPUT){vec2(0,move == MOVE_UP ? -1.0f : 1.0f),SIM_BUTTON_UP};
+        break;
+
+    case MOVE_JUMP_LEFT:
+    case MOVE_JUMP_RIGHT:
+        // Start bouncing, then turn around during the
+        // bounce if facing the wrong way
+        script[len ++] = (SIM_INPUT){vec2(0,0),SIM_BUTTON_PRESSED};
+        if(pl->dir != (move == MOVE_JUMP_LEFT ? 1 : 0))
+        {
+            script[len ++] = (SIM_INPUT){vec2(move == MOVE_JUMP_LEFT ? -1.0f : 1.0f,0),
+                SIM_BUTTON_DOWN};
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return len;
+}
+
+
+// Apply a move
+int turn_apply(GAME_CONTEXT* ctx, int move)
+{
+    SIM_INPUT script[TURN_MAX_SCRIPT];
+    int i = 0;
+    int ret = -1;
+
+    int len = turn_get_script(ctx,move,script);
+    if(len == 0)
+        return TURN_BLOCKED;
+
+    SIM_OBSERVER obs = ctx->observer;
+    void* data = ctx->observerData;
+    int events = 0;
+    int turns = status_get_turn_count(ctx);
+
+    sim_set_observer(ctx,count_event,&events);
+
+    for(; i < len && ret < 0; ++ i)
+    {
+        sim_tick(ctx,&script[i],TURN_TM);
+        ret = get_end(ctx);
+    }
+    if(ret < 0)
+        ret = run_until_settled(ctx);
+
+    sim_set_observer(ctx,obs,data);
+
+    if(ret == TURN_MOVED && events == 0 && turns == status_get_turn_count(ctx))
+        ret = TURN_BLOCKED;
+
+    return ret;
+}
+
+
+// Get move name
+const char* turn_move_name(int move)
+{
+    if(move < 0 || move >= MOVE_COUNT) return "none";
+    return MOVE_NAMES[move];
+}
@@ -0,0 +1,72 @@
+/// Turn resolution (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __TURN__
+#define __TURN__
+
+#include "obase.h"
+#include "sim.h"
+
+#include "stdbool.h"
+
+/// Max ticks one turn may take before giving up
+#define TURN_MAX_TICKS 2000
+/// Max input ticks of a move
+#define TURN_MAX_SCRIPT 2
+
+/// Moves
+enum
+{
+    MOVE_LEFT = 0,
+    MOVE_RIGHT = 1,
+    MOVE_UP = 2,
+    MOVE_DOWN = 3,
+    MOVE_JUMP_LEFT = 4,
+    MOVE_JUMP_RIGHT = 5,
+    MOVE_COUNT = 6,
+};
+
+/// Turn results
+enum
+{
+    TURN_MOVED = 0, /// The state changed
+    TURN_BLOCKED = 1, /// Nothing happened
+    TURN_DEAD = 2, /// The player died
+    TURN_WON = 3, /// The star was reached
+    TURN_STUCK = 4, /// The state did not settle
+};
+
+/// Get if nothing is moving or about to move
+/// < ctx Game context
+/// > True or false
+bool turn_is_settled(GAME_CONTEXT* ctx);
+
+/// Run the simulation with no input until the state
+/// settles, needed once after loading or resetting
+/// < ctx Game context
+/// > Turn result
+int turn_settle(GAME_CONTEXT* ctx);
+
+/// Get the input a player would give for a move, one
+/// entry per tick. After these the stick is let go until
+/// the state settles
+/// < ctx Game context
+/// < move Move
+/// < script Input, TURN_MAX_SCRIPT entries
+/// > Input tick count, 0 if not a move
+int turn_get_script(GAME_CONTEXT* ctx, int move, SIM_INPUT* script);
+
+/// Apply a move & run the simulation until the state has
+/// settled again. Ticks are run at a fixed time step with
+/// the observer muted, so no animation or sound is played
+/// < ctx Game context
+/// < move Move
+/// > Turn result
+int turn_apply(GAME_CONTEXT* ctx, int move);
+
+/// Get the name of a move
+/// < move Move
+/// > Name
+const char* turn_move_name(int move);
+
+#endif // __TURN__
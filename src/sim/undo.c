@@ -0,0 +1,359 @@
+/// Undo & redo history (source)
+/// (c) 2018 Jani Nykänen
+
+#include "undo.h"
+
+#include "sim.h"
+#include "state.h"
+#include "zobrist.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+// Record header: cell & object counts, player, keys,
+// electricity, player direction & the turn counts, old
+// and new values
+#define HEADER_SIZE 14
+// Cell: index, old tile & collision, new tile & collision
+#define CELL_SIZE 5
+// Object: index, old & new value in 3 bytes each
+#define OBJ_SIZE 7
+// Largest possible record, every object spawns on a tile
+#define MAX_RECORD_SIZE (HEADER_SIZE + STAGE_MAX_TILES*CELL_SIZE + STAGE_MAX_TILES*OBJ_SIZE)
+
+
+// Get record size
+static int record_size(const unsigned char* rec)
+{
+    return HEADER_SIZE + rec[0]*CELL_SIZE + rec[1]*OBJ_SIZE;
+}
+
+
+// Get record
+static unsigned char* get_record(UNDO* u, int i)
+{
+    return u->mem + u->records[(u->first + i) % u->maxRecords];
+}
+
+
+// Write a 3-byte value
+static void put24(unsigned char* p, int v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+}
+
+
+// Read a 3-byte value
+static int get24(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16);
+}
+
+
+// Store the current state as the one at the cursor
+static void take_state(UNDO* u, GAME_CONTEXT* ctx)
+{
+    POINT dim = stage_get_map_size(ctx);
+    PLAYER* pl = obj_get_player(ctx);
+    int i = 0;
+
+    memcpy(u->layerData,ctx->stage.layerData,sizeof(int) * dim.x*dim.y);
+    memcpy(u->colMap,ctx->stage.colMap,sizeof(int) * dim.x*dim.y);
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        u->objects[i] = zobrist_object_value(obj_get(ctx,i));
+    }
+    u->playerX = pl->x;
+    u->playerY = pl->y;
+    u->playerDir = pl->dir;
+    u->keyCount = status_get_key_count(ctx);
+    u->turnCount = status_get_turn_count(ctx);
+    u->elecOn = stage_is_electricity_on(ctx);
+    u->hash = sim_get_hash(ctx);
+}
+
+
+// Drop the oldest record
+static void drop_oldest(UNDO* u)
+{
+    u->first = (u->first+1) % u->maxRecords;
+    -- u->count;
+    -- u->cursor;
+    ++ u->dropped;
+}
+
+
+// Copy a record to the ring after the cursor, dropping
+// the redo history & as many old records as needed
+static void push_record(UNDO* u, const unsigned char* rec)
+{
+    int size = record_size(rec);
+    int end = 0;
+    int off = 0;
+    bool wrapped = false;
+    unsigned char* old;
+    int o, os;
+
+    u->count = u->cursor;
+    if(u->count > 0)
+    {
+        old = get_record(u,u->count-1);
+        end = (int)(old - u->mem) + record_size(old);
+        off = end;
+        if(off + size > u->capacity)
+        {
+            off = 0;
+            wrapped = true;
+        }
+    }
+
+    // The oldest records follow the newest one in the ring,
+    // drop the ones in the way
+    while(u->count > 0)
+    {
+        old = get_record(u,0);
+        o = (int)(old - u->mem);
+        os = record_size(old);
+
+        if(u->count < u->maxRecords
+            && !(wrapped && o >= end)
+            && (o >= off+size || off >= o+os))
+            break;
+
+        drop_oldest(u);
+    }
+
+    memcpy(u->mem + off,rec,size);
+    u->records[(u->first + u->count) % u->maxRecords] = off;
+    ++ u->count;
+    ++ u->cursor;
+}
+
+
+// Apply the old or the new side of a record
+static void apply(UNDO* u, GAME_CONTEXT* ctx, const unsigned char* rec, bool useOld)
+{
+    int w = stage_get_map_size(ctx).x;
+    const unsigned char* p = rec + HEADER_SIZE;
+    const unsigned char* objs = p + rec[0]*CELL_SIZE;
+    int side = useOld ? 0 : 1;
+    OBJECT* o;
+    int i, n, v;
+
+    // Objects, placing them may write to the collision map
+    for(i = 0, p = objs; i < rec[1]; ++ i, p += OBJ_SIZE)
+    {
+        n = p[0];
+        v = get24(p + 1 + side*3);
+        state_place_object(ctx,obj_get(ctx,n),v & 0xFF,(v >> 8) & 0xFF,
+            (v >> 16) & 1,(v >> 17) -1);
+        u->objects[n] = v;
+    }
+
+    // Player
+    if(rec[2] != rec[4] || rec[3] != rec[5] || (rec[9] & 1) != (rec[9] >> 1))
+    {
+        u->playerX = rec[2 + side*2];
+        u->playerY = rec[3 + side*2];
+        u->playerDir = (rec[9] >> side) & 1;
+        state_place_player(ctx,u->playerX,u->playerY,u->playerDir);
+    }
+
+    // Tiles
+    for(i = 0, p = rec + HEADER_SIZE; i < rec[0]; ++ i, p += CELL_SIZE)
+    {
+        n = p[0];
+        u->layerData[n] = p[1 + side*2];
+        u->colMap[n] = p[2 + side*2];
+        stage_set_tile(ctx,n % w,n / w,u->layerData[n]);
+        stage_set_collision_tile(ctx,n % w,n / w,u->colMap[n]);
+    }
+
+    // Undo the collision writes in the start positions
+    for(i = 0, p = objs; i < rec[1]; ++ i, p += OBJ_SIZE)
+    {
+        o = obj_get(ctx,p[0]);
+        n = o->startPos.y*w + o->startPos.x;
+        stage_set_collision_tile(ctx,o->startPos.x,o->startPos.y,u->colMap[n]);
+    }
+
+    // Status
+    u->keyCount = rec[6 + side];
+    zobrist_change(ctx,ZOBRIST_KEYS,0,ctx->status.keyCount,u->keyCount);
+    ctx->status.keyCount = u->keyCount;
+
+    u->elecOn = (rec[8] >> side) & 1;
+    if(stage_is_electricity_on(ctx) != u->elecOn)
+        stage_toggle_electricity(ctx);
+
+    u->turnCount = rec[10 + side*2] | (rec[11 + side*2] << 8);
+    ctx->status.turnCount = u->turnCount;
+    ctx->status.victory = false;
+
+    ctx->obj.canMove = true;
+    ctx->input = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    obj_sync_index(ctx);
+    zobrist_update_objects(ctx);
+    u->hash = sim_get_hash(ctx);
+}
+
+
+// Create
+UNDO* undo_create(int size)
+{
+    if(size < MAX_RECORD_SIZE*2)
+        size = MAX_RECORD_SIZE*2;
+
+    UNDO* u = (UNDO*)malloc(sizeof(UNDO));
+    if(u == NULL) return NULL;
+    memset(u,0,sizeof(UNDO));
+
+    u->capacity = size;
+    u->maxRecords = size / HEADER_SIZE + 1;
+    u->mem = (unsigned char*)malloc(size);
+    u->records = (int*)malloc(sizeof(int) * u->maxRecords);
+    if(u->mem == NULL || u->records == NULL)
+    {
+        undo_destroy(u);
+        return NULL;
+    }
+
+    return u;
+}
+
+
+// Begin
+void undo_begin(UNDO* u, GAME_CONTEXT* ctx)
+{
+    u->first = 0;
+    u->count = 0;
+    u->cursor = 0;
+    u->dropped = 0;
+
+    take_state(u,ctx);
+}
+
+
+// Record
+bool undo_record(UNDO* u, GAME_CONTEXT* ctx)
+{
+    unsigned char rec[MAX_RECORD_SIZE];
+
+    POINT dim = stage_get_map_size(ctx);
+    PLAYER* pl = obj_get_player(ctx);
+    int turns = status_get_turn_count(ctx);
+    unsigned char* p = rec + HEADER_SIZE;
+    int i = 0;
+    int v;
+
+    if(sim_get_hash(ctx) == u->hash && turns == u->turnCount)
+        return false;
+
+    rec[0] = 0;
+    rec[1] = 0;
+
+    // Tiles
+    for(; i < dim.x*dim.y; ++ i)
+    {
+        if(ctx->stage.layerData[i] == u->layerData[i]
+            && ctx->stage.colMap[i] == u->colMap[i])
+            continue;
+
+        *(p ++) = (unsigned char)i;
+        *(p ++) = (unsigned char)u->layerData[i];
+        *(p ++) = (unsigned char)u->colMap[i];
+        *(p ++) = (unsigned char)ctx->stage.layerData[i];
+        *(p ++) = (unsigned char)ctx->stage.colMap[i];
+        ++ rec[0];
+    }
+
+    // Objects
+    for(i = 0; i < obj_get_count(ctx); ++ i)
+    {
+        v = zobrist_object_value(obj_get(ctx,i));
+        if(v == u->objects[i]) continue;
+
+        *(p ++) = (unsigned char)i;
+        put24(p,u->objects[i]);
+        put24(p+3,v);
+        p += 6;
+        ++ rec[1];
+    }
+
+    // Player & status
+    rec[2] = (unsigned char)u->playerX;
+    rec[3] = (unsigned char)u->playerY;
+    rec[4] = (unsigned char)pl->x;
+    rec[5] = (unsigned char)pl->y;
+    rec[6] = (unsigned char)u->keyCount;
+    rec[7] = (unsigned char)status_get_key_count(ctx);
+    rec[8] = (unsigned char)(u->elecOn | (stage_is_electricity_on(ctx) << 1));
+    rec[9] = (unsigned char)(u->playerDir | (pl->dir << 1));
+    rec[10] = u->turnCount & 0xFF;
+    rec[11] = (u->turnCount >> 8) & 0xFF;
+    rec[12] = turns & 0xFF;
+    rec[13] = (turns >> 8) & 0xFF;
+
+    push_record(u,rec);
+    take_state(u,ctx);
+
+    return true;
+}
+
+
+// Undo
+int undo_undo(UNDO* u, GAME_CONTEXT* ctx)
+{
+    if(u->cursor == 0) return 1;
+
+    apply(u,ctx,get_record(u,u->cursor-1),true);
+    -- u->cursor;
+
+    return 0;
+}
+
+
+// Redo
+int undo_redo(UNDO* u, GAME_CONTEXT* ctx)
+{
+    if(u->cursor == u->count) return 1;
+
+    apply(u,ctx,get_record(u,u->cursor),false);
+    ++ u->cursor;
+
+    return 0;
+}
+
+
+// Get count
+int undo_get_count(UNDO* u)
+{
+    return u->cursor;
+}
+
+
+// Get memory
+size_t undo_get_memory(UNDO* u)
+{
+    size_t mem = 0;
+    int i = 0;
+    for(; i < u->count; ++ i)
+    {
+        mem += record_size(get_record(u,i));
+    }
+    return mem;
+}
+
+
+// Destroy
+void undo_destroy(UNDO* u)
+{
+    if(u == NULL) return;
+
+    free(u->mem);
+    free(u->records);
+    free(u);
+}
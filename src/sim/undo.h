@@ -0,0 +1,89 @@
+/// Undo & redo history (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __UNDO__
+#define __UNDO__
+
+#include "obase.h"
+#include "stage.h"
+#include "objects.h"
+
+#include "stdbool.h"
+#include "stddef.h"
+
+/// Default history size in bytes
+#define UNDO_DEFAULT_SIZE (256 * 1024)
+
+/// Undo history. Every turn is stored as a diff against
+/// the previous turn in a ring buffer, the oldest turns
+/// are dropped when the buffer is full
+typedef struct
+{
+    unsigned char* mem; /// Ring buffer
+    int capacity; /// Ring buffer size in bytes
+    int* records; /// Record offsets, a ring as well
+    int maxRecords; /// Record offset count
+    int first; /// Oldest record
+    int count; /// Stored records
+    int cursor; /// Applied records, the ones after can be redone
+    long dropped; /// Records dropped to fit the buffer
+
+    // The state at the cursor, the diffs are made against it
+    int layerData[STAGE_MAX_TILES];
+    int colMap[STAGE_MAX_TILES];
+    int objects[STAGE_MAX_TILES];
+    int playerX;
+    int playerY;
+    int playerDir;
+    int keyCount;
+    int turnCount;
+    bool elecOn;
+    unsigned long long hash;
+}
+UNDO;
+
+/// Create an undo history
+/// < size Ring buffer size in bytes
+/// > A new history, NULL on error
+UNDO* undo_create(int size);
+
+/// Clear the history & start from the current state
+/// < u History
+/// < ctx Game context
+void undo_begin(UNDO* u, GAME_CONTEXT* ctx);
+
+/// Record a turn if the state has changed since the last
+/// record. The redo history is dropped. Call only when
+/// the state is settled
+/// < u History
+/// < ctx Game context
+/// > True if a turn was recorded
+bool undo_record(UNDO* u, GAME_CONTEXT* ctx);
+
+/// Undo a turn, in time relative to the changes
+/// < u History
+/// < ctx Game context
+/// > 0 on success, 1 if there is nothing to undo
+int undo_undo(UNDO* u, GAME_CONTEXT* ctx);
+
+/// Redo a turn
+/// < u History
+/// < ctx Game context
+/// > 0 on success, 1 if there is nothing to redo
+int undo_redo(UNDO* u, GAME_CONTEXT* ctx);
+
+/// Get the turns that can be undone
+/// < u History
+/// > Turn count
+int undo_get_count(UNDO* u);
+
+/// Get the memory used by the stored turns
+/// < u History
+/// > Size in bytes
+size_t undo_get_memory(UNDO* u);
+
+/// Destroy an undo history
+/// < u History
+void undo_destroy(UNDO* u);
+
+#endif // __UNDO__
@@ -0,0 +1,124 @@
+/// Zobrist hashing of the game state (source)
+/// (c) 2018 Jani Nykänen
+
+#include "zobrist.h"
+
+#include "sim.h"
+#include "enemy.h"
+
+#include "stdlib.h"
+
+
+// Get key
+unsigned long long zobrist_key(int feature, int index, int value)
+{
+    // SplitMix64 finalizer
+    unsigned long long z = ((unsigned long long)feature << 56)
+        ^ ((unsigned long long)(unsigned int)index << 32) ^ (unsigned int)value;
+
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+// Toggle
+void zobrist_toggle(GAME_CONTEXT* ctx, int feature, int index, int value)
+{
+    ctx->hash ^= zobrist_key(feature,index,value);
+}
+
+
+// Change
+void zobrist_change(GAME_CONTEXT* ctx, int feature, int index, int oldValue, int newValue)
+{
+    if(oldValue == newValue) return;
+
+    ctx->hash ^= zobrist_key(feature,index,oldValue) ^ zobrist_key(feature,index,newValue);
+}
+
+
+// Get object value
+int zobrist_object_value(OBJECT* o)
+{
+    int dir = o->type == OBJ_ENEMY ? ((ENEMY*)o)->dir +1 : 0;
+
+    return o->x | (o->y << 8) | (o->exist << 16) | (dir << 17);
+}
+
+
+// Get player value
+int zobrist_player_value(GAME_CONTEXT* ctx)
+{
+    PLAYER* pl = obj_get_player(ctx);
+
+    return pl->x | (pl->y << 8) | (pl->dir << 16);
+}
+
+
+// Compute
+unsigned long long zobrist_compute(GAME_CONTEXT* ctx)
+{
+    unsigned long long h = 0;
+    int tiles = 0;
+    int i = 0;
+
+    if(ctx->stage.map != NULL)
+        tiles = ctx->stage.map->width * ctx->stage.map->height;
+
+    for(; i < tiles; ++ i)
+    {
+        h ^= zobrist_key(ZOBRIST_TILE,i,ctx->stage.layerData[i]);
+        h ^= zobrist_key(ZOBRIST_COLLISION,i,ctx->stage.colMap[i]);
+    }
+    for(i = 0; i < obj_get_count(ctx); ++ i)
+    {
+        h ^= zobrist_key(ZOBRIST_OBJECT,i,zobrist_object_value(obj_get(ctx,i)));
+    }
+    h ^= zobrist_key(ZOBRIST_PLAYER,0,zobrist_player_value(ctx));
+    h ^= zobrist_key(ZOBRIST_KEYS,0,ctx->status.keyCount);
+    h ^= zobrist_key(ZOBRIST_ELECTRICITY,0,ctx->stage.elecOn);
+
+    return h;
+}
+
+
+// Reset
+void zobrist_reset(GAME_CONTEXT* ctx)
+{
+    int i = 0;
+
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        ctx->obj.hashed[i] = zobrist_object_value(obj_get(ctx,i));
+    }
+    ctx->obj.playerHashed = zobrist_player_value(ctx);
+
+    ctx->hash = zobrist_compute(ctx);
+}
+
+
+// Update objects
+void zobrist_update_objects(GAME_CONTEXT* ctx)
+{
+    int i = 0;
+    int v;
+
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        v = zobrist_object_value(obj_get(ctx,i));
+        if(v != ctx->obj.hashed[i])
+        {
+            zobrist_change(ctx,ZOBRIST_OBJECT,i,ctx->obj.hashed[i],v);
+            ctx->obj.hashed[i] = v;
+        }
+    }
+
+    v = zobrist_player_value(ctx);
+    if(v != ctx->obj.playerHashed)
+    {
+        zobrist_change(ctx,ZOBRIST_PLAYER,0,ctx->obj.playerHashed,v);
+        ctx->obj.playerHashed = v;
+    }
+}
@@ -0,0 +1,69 @@
+/// Zobrist hashing of the game state (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __ZOBRIST__
+#define __ZOBRIST__
+
+#include "obase.h"
+
+/// Hashed features
+enum
+{
+    ZOBRIST_TILE = 0,
+    ZOBRIST_COLLISION = 1,
+    ZOBRIST_OBJECT = 2,
+    ZOBRIST_PLAYER = 3,
+    ZOBRIST_KEYS = 4,
+    ZOBRIST_ELECTRICITY = 5,
+};
+
+/// Get the key of a feature. Keys are made by mixing the
+/// feature bits, so no table needs to be initialized
+/// < feature Feature
+/// < index Tile or object index
+/// < value Feature value
+/// > Key
+unsigned long long zobrist_key(int feature, int index, int value);
+
+/// Toggle a feature value in the hash
+/// < ctx Game context
+/// < feature Feature
+/// < index Tile or object index
+/// < value Feature value
+void zobrist_toggle(GAME_CONTEXT* ctx, int feature, int index, int value);
+
+/// Change a feature value in the hash
+/// < ctx Game context
+/// < feature Feature
+/// < index Tile or object index
+/// < oldValue Old value
+/// < newValue New value
+void zobrist_change(GAME_CONTEXT* ctx, int feature, int index, int oldValue, int newValue);
+
+/// Get the hashed value of an object: position, existence
+/// and the enemy direction
+/// < o Object
+/// > Value
+int zobrist_object_value(OBJECT* o);
+
+/// Get the hashed value of the player: position and
+/// direction, as turning around can open a lock
+/// < ctx Game context
+/// > Value
+int zobrist_player_value(GAME_CONTEXT* ctx);
+
+/// Compute the hash from scratch
+/// < ctx Game context
+/// > Hash
+unsigned long long zobrist_compute(GAME_CONTEXT* ctx);
+
+/// Recompute the hash & the object values it was built from,
+/// needed after the state is rewritten as a whole
+/// < ctx Game context
+void zobrist_reset(GAME_CONTEXT* ctx);
+
+/// Hash the objects that moved since the last call
+/// < ctx Game context
+void zobrist_update_objects(GAME_CONTEXT* ctx);
+
+#endif // __ZOBRIST__
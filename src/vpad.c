@@ -25,6 +25,13 @@ static VEC2 delta;
 // Buttons
 static BUTTON buttons[256];
 
+// Is the input overridden
+static bool overridden;
+// Override stick
+static VEC2 overStick;
+// Override buttons
+static int overButtons[VPAD_OVERRIDE_BUTTONS];
+
 
 // Initialize virtual gamepad
 void vpad_init()
@@ -75,6 +82,7 @@ void vpad_update()
 // Get stick axis
 VEC2 vpad_get_stick()
 {
+    if(overridden) return overStick;
     return stick;
 }
 
@@ -96,6 +104,9 @@ void vpad_add_button(Uint8 index, int scancode, int joybutton)
 // Get virtual pad button state
 int vpad_get_button(Uint8 index)
 {
+    if(overridden)
+        return index < VPAD_OVERRIDE_BUTTONS ? overButtons[index] : UP;
+
     int ret = get_key_state(buttons[index].scancode);;
     if(ret == UP)
     {
@@ -111,4 +122,25 @@ void vpad_flush_stick()
 {
     stick.x = 0.0f;
     stick.y = 0.0f;
+}
+
+
+// Override
+void vpad_override(VEC2 st, const int* b)
+{
+    int i = 0;
+
+    overridden = true;
+    overStick = st;
+    for(; i < VPAD_OVERRIDE_BUTTONS; ++ i)
+    {
+        overButtons[i] = b[i];
+    }
+}
+
+
+// Release override
+void vpad_release_override()
+{
+    overridden = false;
 }
\ No newline at end of file
@@ -7,6 +7,11 @@
 #include "engine/controls.h"
 #include "engine/vector.h"
 
+#include "stdbool.h"
+
+/// Button count in the override state
+#define VPAD_OVERRIDE_BUTTONS 6
+
 /// Initialize virtual gamepad
 void vpad_init();
 
@@ -34,4 +39,13 @@ int vpad_get_button(Uint8 index);
 /// Set stick position to zero
 void vpad_flush_stick();
 
+/// Replace the stick & the buttons with a given state,
+/// used for playing back recorded input
+/// < stick Stick position
+/// < buttons Button states, VPAD_OVERRIDE_BUTTONS of them
+void vpad_override(VEC2 stick, const int* buttons);
+
+/// Go back to the real input
+void vpad_release_override();
+
 #endif // __VPAD__
\ No newline at end of file
@@ -0,0 +1,604 @@
+/// Headless simulation runner (source)
+/// (c) 2018 Jani Nykänen
+
+#include "../src/sim/sim.h"
+#include "../src/sim/stage.h"
+#include "../src/sim/status.h"
+#include "../src/sim/objects.h"
+#include "../src/sim/turn.h"
+#include "../src/sim/zobrist.h"
+#include "../src/sim/ttable.h"
+#include "../src/sim/state.h"
+#include "../src/sim/undo.h"
+#include "../src/sim/replay.h"
+
+#include "playback.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+#include "pthread.h"
+
+// Default tick count
+#define DEFAULT_TICKS 20000
+// Ticks one random input is held
+#define INPUT_HOLD 24
+// Maximum amount of maps
+#define MAX_MAPS 64
+// Maximum amount of threads
+#define MAX_THREADS 64
+// Transposition table size for the loop detection
+#define LOOP_TT_SIZE (1024 * 1024)
+// Max objects looked up in a cell
+#define MAX_CELL_OBJECTS 16
+
+// Result of one run
+typedef struct
+{
+    unsigned int checksum;
+    int deaths;
+    int wins;
+    int hashErrors;
+    int indexErrors;
+    int repeats;
+    int undoErrors;
+    size_t undoMemory;
+    int undoTurns;
+    int events[SIM_EVENT_VICTORY +1];
+    bool resetRequest;
+}
+RESULT;
+
+// Thread running every map in its own context
+typedef struct
+{
+    pthread_t thread;
+    TILEMAP** maps;
+    int mapCount;
+    int ticks;
+    RESULT results[MAX_MAPS];
+}
+WORKER;
+
+// Random seed
+static const unsigned int SEED = 1;
+
+// Play whole turns instead of ticks
+static bool turnMode = false;
+// Undo & redo every turn after playing
+static bool undoMode = false;
+
+
+// Count events, stand-in for the presentation
+static void on_event(const SIM_EVENT* ev, void* data)
+{
+    RESULT* res = (RESULT*)data;
+
+    ++ res->events[ev->type];
+    if(ev->type == SIM_EVENT_DEATH_END)
+        res->resetRequest = true;
+}
+
+
+// A simple deterministic random number generator
+static unsigned int next_random(unsigned int* seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7FFF;
+}
+
+
+// Random input, held for a while like a player would
+static SIM_INPUT random_input(unsigned int* seed)
+{
+    SIM_INPUT in = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    switch(next_random(seed) % 6)
+    {
+    case 0: in.stick.x = -1.0f; break;
+    case 1: in.stick.x = 1.0f; break;
+    case 2: in.stick.y = -1.0f; break;
+    case 3: in.stick.y = 1.0f; break;
+    case 4: in.jump = SIM_BUTTON_PRESSED; break;
+    default: break;
+    }
+
+    return in;
+}
+
+
+// Checksum of the grid state
+static unsigned int state_checksum(GAME_CONTEXT* ctx)
+{
+    unsigned int h = 2166136261u;
+    POINT dim = stage_get_map_size(ctx);
+    PLAYER* pl = obj_get_player(ctx);
+    OBJECT* o;
+    int i = 0;
+    int x, y;
+
+    #define MIX(v) h = (h ^ (unsigned int)(v)) * 16777619u
+
+    for(y = 0; y < dim.y; ++ y)
+    {
+        for(x = 0; x < dim.x; ++ x)
+        {
+            MIX(stage_get_tile(ctx,x,y));
+            MIX(stage_get_collision_map(ctx)[y*dim.x + x]);
+        }
+    }
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        o = obj_get(ctx,i);
+        MIX(o->x); MIX(o->y); MIX(o->exist);
+    }
+    MIX(pl->x); MIX(pl->y); MIX(pl->dying);
+    MIX(status_get_turn_count(ctx));
+    MIX(status_get_key_count(ctx));
+    MIX(stage_is_electricity_on(ctx));
+
+    #undef MIX
+
+    return h;
+}
+
+
+// The incremental hash must match one computed from scratch,
+// & every existing object must be found in its cell
+static void check_hash(GAME_CONTEXT* ctx, RESULT* res)
+{
+    int found[MAX_CELL_OBJECTS];
+    OBJECT* o;
+    int i = 0;
+    int j, n;
+
+    if(sim_get_hash(ctx) != zobrist_compute(ctx))
+        ++ res->hashErrors;
+
+    for(; i < obj_get_count(ctx); ++ i)
+    {
+        o = obj_get(ctx,i);
+        if(!o->exist) continue;
+
+        n = obj_get_at(ctx,o->x,o->y,found,MAX_CELL_OBJECTS);
+        for(j = 0; j < n && found[j] != i; ++ j);
+        if(j == n)
+            ++ res->indexErrors;
+    }
+}
+
+
+// Run a map with random input
+static void run(GAME_CONTEXT* ctx, TILEMAP* map, int ticks, unsigned int seed, RESULT* res)
+{
+    SIM_INPUT in = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+    int i = 0;
+
+    memset(res,0,sizeof(RESULT));
+    sim_set_observer(ctx,on_event,res);
+
+    if(sim_load(ctx,map) != 0)
+        return;
+
+    for(; i < ticks; ++ i)
+    {
+        if(i % INPUT_HOLD == 0)
+            in = random_input(&seed);
+        else if(in.jump == SIM_BUTTON_PRESSED)
+            in.jump = SIM_BUTTON_UP;
+
+        sim_tick(ctx,&in,1.0f);
+        if(i % INPUT_HOLD == 0)
+            check_hash(ctx,res);
+
+        // Start over after a death or a victory
+        if(res->resetRequest || status_is_victory(ctx))
+        {
+            if(res->resetRequest) ++ res->deaths;
+            else ++ res->wins;
+
+            res->resetRequest = false;
+            sim_reset(ctx);
+        }
+    }
+
+    check_hash(ctx,res);
+    res->checksum = state_checksum(ctx);
+}
+
+
+// Run a map with random moves
+// Positions seen again since the last reset are counted
+// as loops
+static void run_turns(GAME_CONTEXT* ctx, TILEMAP* map, int turns, unsigned int seed, RESULT* res)
+{
+    TT_ENTRY e;
+    int i = 0;
+    int ret;
+
+    memset(res,0,sizeof(RESULT));
+    sim_set_observer(ctx,on_event,res);
+
+    TTABLE* tt = tt_create(LOOP_TT_SIZE);
+    if(tt == NULL)
+    {
+        printf("Failed to create a transposition table\n");
+        return;
+    }
+
+    if(sim_load(ctx,map) != 0 || turn_settle(ctx) == TURN_STUCK)
+    {
+        tt_destroy(tt);
+        return;
+    }
+
+    for(; i < turns; ++ i)
+    {
+        ret = turn_apply(ctx,next_random(&seed) % MOVE_COUNT);
+        if(ret == TURN_STUCK)
+        {
+            printf("Turn %d did not settle\n",i);
+            tt_destroy(tt);
+            return;
+        }
+        check_hash(ctx,res);
+
+        // Start over after a death or a victory
+        if(ret == TURN_DEAD || ret == TURN_WON)
+        {
+            if(ret == TURN_DEAD) ++ res->deaths;
+            else ++ res->wins;
+
+            sim_reset(ctx);
+            turn_settle(ctx);
+            tt_clear(tt);
+        }
+        else if(ret == TURN_MOVED)
+        {
+            if(tt_probe(tt,sim_get_hash(ctx),&e))
+                ++ res->repeats;
+            else
+                tt_store(tt,sim_get_hash(ctx),i,0);
+        }
+    }
+
+    tt_destroy(tt);
+    res->checksum = state_checksum(ctx);
+}
+
+
+// Play random turns recording them, then undo & redo
+// all of them. Every step must match the packed state
+// of the turn
+static void run_undo(GAME_CONTEXT* ctx, TILEMAP* map, int turns, unsigned int seed, RESULT* res)
+{
+    unsigned char* states = NULL;
+    unsigned char* cur;
+    UNDO* u = NULL;
+    int size = 0;
+    int played = 0;
+    int i, ret;
+
+    memset(res,0,sizeof(RESULT));
+    sim_set_observer(ctx,on_event,res);
+
+    if(sim_load(ctx,map) != 0 || turn_settle(ctx) == TURN_STUCK)
+        return;
+
+    size = state_get_size(ctx);
+    states = (unsigned char*)malloc((size_t)size * (turns+2));
+    u = undo_create(UNDO_DEFAULT_SIZE);
+    if(states == NULL || u == NULL)
+    {
+        printf("Failed to allocate memory\n");
+        free(states);
+        undo_destroy(u);
+        return;
+    }
+
+    cur = states + (size_t)size * (turns+1);
+
+    undo_begin(u,ctx);
+    state_pack(ctx,states);
+    for(i = 0; i < turns; ++ i)
+    {
+        ret = turn_apply(ctx,next_random(&seed) % MOVE_COUNT);
+        if(ret == TURN_STUCK) break;
+
+        if(ret == TURN_DEAD || ret == TURN_WON)
+        {
+            if(ret == TURN_DEAD) ++ res->deaths;
+            else ++ res->wins;
+
+            sim_reset(ctx);
+            turn_settle(ctx);
+        }
+
+        if(undo_record(u,ctx))
+            state_pack(ctx,states + (size_t)size * (++ played));
+    }
+    res->undoTurns = undo_get_count(u);
+    res->undoMemory = undo_get_memory(u);
+
+    // Back to the oldest turn left & forth again
+    for(i = played; undo_undo(u,ctx) == 0; )
+    {
+        -- i;
+        state_pack(ctx,cur);
+        if(memcmp(states + (size_t)size * i,cur,size) != 0
+            || sim_get_hash(ctx) != zobrist_compute(ctx))
+            ++ res->undoErrors;
+    }
+    while(undo_redo(u,ctx) == 0)
+    {
+        ++ i;
+        state_pack(ctx,cur);
+        if(memcmp(states + (size_t)size * i,cur,size) != 0
+            || sim_get_hash(ctx) != zobrist_compute(ctx))
+            ++ res->undoErrors;
+    }
+
+    free(states);
+    undo_destroy(u);
+    res->checksum = state_checksum(ctx);
+}
+
+
+// Run a map in the chosen mode
+static void run_map(GAME_CONTEXT* ctx, TILEMAP* map, int count, RESULT* res)
+{
+    if(undoMode)
+        run_undo(ctx,map,count,SEED,res);
+    else if(turnMode)
+        run_turns(ctx,map,count,SEED,res);
+    else
+        run(ctx,map,count,SEED,res);
+}
+
+
+// Run every map in a context of its own
+static void* worker_run(void* data)
+{
+    WORKER* w = (WORKER*)data;
+    GAME_CONTEXT ctx;
+    int i = 0;
+
+    sim_init(&ctx);
+    for(; i < w->mapCount; ++ i)
+    {
+        run_map(&ctx,w->maps[i],w->ticks,&w->results[i]);
+    }
+    sim_destroy(&ctx);
+
+    return NULL;
+}
+
+
+// Wall clock time in seconds
+static double wall_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+
+// Run the maps in many threads at once, each thread must
+// end up in the same states as the serial runs
+static int run_parallel(TILEMAP** maps, int mapCount, int ticks, int threads,
+    unsigned int* expected)
+{
+    static WORKER workers[MAX_THREADS];
+
+    int failed = 0;
+    int i = 0;
+    int j;
+
+    double start = wall_time();
+    for(; i < threads; ++ i)
+    {
+        workers[i].maps = maps;
+        workers[i].mapCount = mapCount;
+        workers[i].ticks = ticks;
+        if(pthread_create(&workers[i].thread,NULL,worker_run,&workers[i]) != 0)
+        {
+            printf("Failed to create a thread\n");
+            return 1;
+        }
+    }
+    for(i = 0; i < threads; ++ i)
+    {
+        pthread_join(workers[i].thread,NULL);
+    }
+    double time = wall_time() - start;
+
+    for(i = 0; i < threads; ++ i)
+    {
+        for(j = 0; j < mapCount; ++ j)
+        {
+            if(workers[i].results[j].checksum != expected[j]
+                || workers[i].results[j].hashErrors > 0
+                || workers[i].results[j].indexErrors > 0
+                || workers[i].results[j].undoErrors > 0)
+            {
+                printf("Thread %d, map %d: %08x, expected %08x\n",
+                    i,j+1,workers[i].results[j].checksum,expected[j]);
+                ++ failed;
+            }
+        }
+    }
+
+    printf("%d threads: %s, %.0f %s/s in total\n",threads,
+        failed == 0 ? "ok" : "MISMATCH",
+        time > 0.0 ? (double)ticks * mapCount * threads / time : 0.0,
+        turnMode ? "turns" : "ticks");
+
+    return failed;
+}
+
+
+// Play replays back, the result must match the recorded one
+static int run_replays(char** paths, int count)
+{
+    PLAYBACK_RESULT res;
+    GAME_CONTEXT ctx;
+    char path[32];
+    int failed = 0;
+    int i = 0;
+
+    sim_init(&ctx);
+    for(; i < count; ++ i)
+    {
+        REPLAY* r = replay_load(paths[i]);
+        if(r == NULL)
+        {
+            printf("%s: failed to load\n",paths[i]);
+            ++ failed;
+            continue;
+        }
+
+        snprintf(path,32,"assets/maps/%02d.tmx",r->stage+1);
+        TILEMAP* map = load_tilemap(path);
+        if(map == NULL || tmx_extract_spawns(map,0,stage_is_spawn_tile) != 0
+            || playback_run(&ctx,map,r,&res) != 0)
+        {
+            printf("%s: failed to play %s\n",paths[i],path);
+            ++ failed;
+        }
+        else
+        {
+            bool ok = playback_matches(r,&res);
+            printf("%s: stage %02d, %s, %s in %d turns (recorded %d), %ld frames in %d bytes, %.0f ticks/s\n",
+                paths[i],r->stage+1,ok ? "ok" : "MISMATCH",res.victory ? "victory" : "no victory",
+                res.turns,r->turns,r->frameCount,(int)(r->size + r->traceSize),
+                res.time > 0.0 ? res.ticks / res.time : 0.0);
+            if(res.divergedAt >= 0)
+                printf("  diverged at tick %ld, hash %08x, traced %08x\n",
+                    res.divergedAt,res.actual,res.expected);
+            if(!ok) ++ failed;
+        }
+
+        if(map != NULL)
+            destroy_tilemap(map);
+        replay_destroy(r);
+    }
+    sim_destroy(&ctx);
+
+    return failed > 0 ? 1 : 0;
+}
+
+
+// Main
+// Usage: headless [-t] [-u] [-j threads] [ticks] [map files...]
+//        headless -r [replay files...]
+// With -t, whole turns are played instead of ticks, with -u
+// the turns are also undone & redone. With -r, replays
+// are played back
+int main(int argc, char** argv)
+{
+    static TILEMAP* maps[MAX_MAPS];
+    static unsigned int checksums[MAX_MAPS];
+
+    GAME_CONTEXT ctx;
+    RESULT res;
+    char path[32];
+    int threads = 0;
+    int first = 1;
+
+    for(; first < argc && argv[first][0] == '-'; ++ first)
+    {
+        if(strcmp(argv[first],"-t") == 0)
+        {
+            turnMode = true;
+        }
+        else if(strcmp(argv[first],"-r") == 0)
+        {
+            return run_replays(argv + first+1,argc - first-1);
+        }
+        else if(strcmp(argv[first],"-u") == 0)
+        {
+            turnMode = true;
+            undoMode = true;
+        }
+        else if(strcmp(argv[first],"-j") == 0 && first+1 < argc)
+        {
+            threads = (int)strtol(argv[++ first],NULL,10);
+            if(threads < 0) threads = 0;
+            if(threads > MAX_THREADS) threads = MAX_THREADS;
+        }
+        else
+        {
+            printf("Usage: headless [-t] [-u] [-j threads] [ticks] [map files...]\n"
+                "       headless -r [replay files...]\n");
+            return 1;
+        }
+    }
+
+    int ticks = argc > first ? (int)strtol(argv[first],NULL,10) : DEFAULT_TICKS;
+    if(ticks <= 0) ticks = DEFAULT_TICKS;
+
+    int count = argc > first+1 ? argc-first-1 : 25;
+    if(count > MAX_MAPS) count = MAX_MAPS;
+
+    int failed = 0;
+    int i = 0;
+
+    // Load the maps & extract the spawns beforehand,
+    // so the contexts only read the shared maps
+    for(; i < count; ++ i)
+    {
+        if(argc > first+1)
+            snprintf(path,32,"%s",argv[first+1 + i]);
+        else
+            snprintf(path,32,"assets/maps/%02d.tmx",i+1);
+
+        maps[i] = load_tilemap(path);
+        if(maps[i] == NULL || tmx_extract_spawns(maps[i],0,stage_is_spawn_tile) != 0)
+        {
+            printf("Failed to load %s\n",path);
+            return 1;
+        }
+    }
+
+    sim_init(&ctx);
+    for(i = 0; i < count; ++ i)
+    {
+        // Two runs with the same input must end in the same state
+        clock_t start = clock();
+        run_map(&ctx,maps[i],ticks,&res);
+        double time = (double)(clock() - start) / CLOCKS_PER_SEC;
+        unsigned int a = res.checksum;
+        run_map(&ctx,maps[i],ticks,&res);
+
+        printf("map %02d: %08x %s, %d deaths, %d wins, %d jumps, %d pushes, ",
+            i+1,a,a == res.checksum ? "ok" : "MISMATCH",res.deaths,res.wins,
+            res.events[SIM_EVENT_JUMP],res.events[SIM_EVENT_PUSH]);
+        if(undoMode)
+            printf("%d undone in %d bytes (%.1f bytes/turn)%s, ",res.undoTurns,(int)res.undoMemory,
+                res.undoTurns > 0 ? (double)res.undoMemory / res.undoTurns : 0.0,
+                res.undoErrors > 0 ? " with ERRORS" : "");
+        else if(turnMode)
+            printf("%d repeats, ",res.repeats);
+        if(res.hashErrors > 0)
+            printf("%d HASH ERRORS, ",res.hashErrors);
+        if(res.indexErrors > 0)
+            printf("%d INDEX ERRORS, ",res.indexErrors);
+        printf("%.0f %s/s\n",time > 0.0 ? ticks / time : 0.0,turnMode ? "turns" : "ticks");
+        if(a != res.checksum || res.hashErrors > 0 || res.indexErrors > 0
+            || res.undoErrors > 0) ++ failed;
+
+        checksums[i] = a;
+    }
+    sim_destroy(&ctx);
+
+    if(threads > 0)
+        failed += run_parallel(maps,count,ticks,threads,checksums);
+
+    for(i = 0; i < count; ++ i)
+    {
+        destroy_tilemap(maps[i]);
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+/// Replay playback without the presentation (source)
+/// (c) 2018 Jani Nykänen
+
+#include "playback.h"
+
+#include "../src/sim/turn.h"
+#include "../src/sim/undo.h"
+
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+// Game scene buttons
+#define BUTTON_JUMP 0
+#define BUTTON_RESTART 2
+#define BUTTON_UNDO 4
+#define BUTTON_REDO 5
+
+
+// Set when the death animation has ended
+static void on_event(const SIM_EVENT* ev, void* data)
+{
+    if(ev->type == SIM_EVENT_DEATH_END)
+        *((bool*)data) = true;
+}
+
+
+// Trace cursor
+typedef struct
+{
+    bool more; /// Are there entries left
+    long tick; /// Tick of the next entry
+    unsigned int hash; /// Hash of the next entry
+    unsigned int current; /// Hash expected now
+}
+TRACE;
+
+
+// Compare the state against the trace, the hash of a
+// tick being the one of the last entry before it
+static void check_trace(GAME_CONTEXT* ctx, REPLAY* r, TRACE* t, PLAYBACK_RESULT* res)
+{
+    if(r->traceSize == 0 || res->divergedAt >= 0) return;
+
+    while(t->more && t->tick <= res->ticks)
+    {
+        t->current = t->hash;
+        t->more = replay_next_trace(r,&t->tick,&t->hash);
+    }
+
+    unsigned int hash = (unsigned int)sim_get_hash(ctx);
+    if(hash != t->current)
+    {
+        res->divergedAt = res->ticks;
+        res->expected = t->current;
+        res->actual = hash;
+    }
+}
+
+
+// Wall clock time in seconds
+static double wall_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+
+// Run
+int playback_run(GAME_CONTEXT* ctx, TILEMAP* map, REPLAY* r, PLAYBACK_RESULT* res)
+{
+    const float TM = 1.0f;
+
+    REPLAY_FRAME f;
+    SIM_INPUT in;
+    TRACE trace;
+    bool reset = false;
+
+    memset(res,0,sizeof(PLAYBACK_RESULT));
+    res->divergedAt = -1;
+
+    UNDO* undo = undo_create(UNDO_DEFAULT_SIZE);
+    if(undo == NULL) return 1;
+
+    // Like setting the stage in the game
+    sim_set_observer(ctx,on_event,&reset);
+    if(sim_load(ctx,map) != 0)
+    {
+        undo_destroy(undo);
+        return 1;
+    }
+    undo_begin(undo,ctx);
+    sim_reset(ctx);
+
+    double start = wall_time();
+    replay_rewind(r);
+    trace.more = replay_next_trace(r,&trace.tick,&trace.hash);
+    trace.current = 0;
+    while(replay_next(r,&f))
+    {
+        in = (SIM_INPUT){replay_frame_stick(&f),replay_frame_button(&f,BUTTON_JUMP)};
+        sim_tick(ctx,&in,TM);
+        ++ res->ticks;
+
+        if(status_is_victory(ctx))
+        {
+            res->victory = true;
+            check_trace(ctx,r,&trace,res);
+            break;
+        }
+
+        // Undo & redo
+        if(turn_is_settled(ctx) && !obj_get_player(ctx)->dying)
+        {
+            undo_record(undo,ctx);
+            if(replay_frame_button(&f,BUTTON_UNDO) == SIM_BUTTON_PRESSED)
+                undo_undo(undo,ctx);
+            else if(replay_frame_button(&f,BUTTON_REDO) == SIM_BUTTON_PRESSED)
+                undo_redo(undo,ctx);
+        }
+
+        check_trace(ctx,r,&trace,res);
+
+        // The game resets after the transition, during which
+        // no input is read
+        if(reset || replay_frame_button(&f,BUTTON_RESTART) == SIM_BUTTON_PRESSED)
+        {
+            reset = false;
+            sim_reset(ctx);
+        }
+    }
+    res->time = wall_time() - start;
+
+    res->turns = status_get_turn_count(ctx);
+    res->hash = sim_get_hash(ctx);
+
+    sim_set_observer(ctx,NULL,NULL);
+    undo_destroy(undo);
+
+    return 0;
+}
+
+
+// Matches
+bool playback_matches(REPLAY* r, PLAYBACK_RESULT* res)
+{
+    if(!r->finished) return false;
+
+    return r->victory == res->victory && r->turns == res->turns && r->hash == res->hash
+        && res->divergedAt < 0;
+}
@@ -0,0 +1,42 @@
+/// Replay playback without the presentation (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __PLAYBACK__
+#define __PLAYBACK__
+
+#include "../src/sim/sim.h"
+#include "../src/sim/replay.h"
+
+/// Playback result
+typedef struct
+{
+    bool victory; /// Did the replay end in a victory
+    int turns; /// Turn count in the end
+    unsigned long long hash; /// State hash in the end
+    long ticks; /// Ticks simulated
+    double time; /// Wall clock time in seconds
+
+    long divergedAt; /// First tick not matching the trace, -1 if none
+    unsigned int expected; /// Traced hash in that tick
+    unsigned int actual; /// Hash in that tick
+}
+PLAYBACK_RESULT;
+
+/// Play a replay back, doing what the game scene does
+/// with each frame: the restart, the undo & the resets
+/// after a death. The state hash is compared against the
+/// trace of the replay after every frame
+/// < ctx Game context
+/// < map Stage map, the spawns must be extracted
+/// < r Replay
+/// < res Result
+/// > 0 on success, 1 on error
+int playback_run(GAME_CONTEXT* ctx, TILEMAP* map, REPLAY* r, PLAYBACK_RESULT* res);
+
+/// Does the result match the one stored in the replay
+/// < r Replay
+/// < res Result
+/// > True or false
+bool playback_matches(REPLAY* r, PLAYBACK_RESULT* res);
+
+#endif // __PLAYBACK__
@@ -0,0 +1,791 @@
+/// Parallel state-space search (source)
+/// (c) 2018 Jani Nykänen
+
+#include "search.h"
+
+#include "../src/sim/sim.h"
+#include "../src/sim/turn.h"
+#include "../src/sim/state.h"
+#include "../src/sim/ttable.h"
+#include "../src/sim/zobrist.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdbool.h"
+#include "stdatomic.h"
+#include "time.h"
+#include "pthread.h"
+#include "sched.h"
+
+// Visited-set shards, node IDs are (shard << LOCAL_BITS) | index
+#define SHARD_BITS 6
+#define SHARD_COUNT (1 << SHARD_BITS)
+#define LOCAL_BITS 25
+// Transposition table size of a worker
+#define WORKER_TT_SIZE (4 * 1024 * 1024)
+// Visited-set keys of a state at most
+#define MAX_KEYS 32
+
+// Work item, a node & the cost it was queued with
+typedef struct
+{
+    int node;
+    int cost;
+}
+ITEM;
+
+// Double-ended work queue. The owner takes from the
+// bottom, thieves from the top
+typedef struct
+{
+    pthread_mutex_t lock;
+    ITEM* items;
+    unsigned int head;
+    unsigned int tail;
+    unsigned int size;
+}
+DEQUE;
+
+// A part of the visited-set with its own lock
+typedef struct
+{
+    pthread_mutex_t lock;
+
+    unsigned char* keys;
+    unsigned long long* hashes;
+    int* parent;
+    unsigned char* move;
+    int* cost;
+    int count;
+    int capacity;
+
+    int* table;
+    unsigned int tableSize;
+}
+SHARD;
+
+// Worker thread
+typedef struct
+{
+    pthread_t thread;
+    int index;
+    GAME_CONTEXT ctx;
+    unsigned char* key;
+    unsigned char* child;
+    TTABLE* tt;
+    DEQUE queue[2];
+    long expanded;
+    long steals;
+    long filtered;
+    unsigned int seed;
+}
+WORKER;
+
+// Shared search state
+static SHARD shards[SHARD_COUNT];
+static WORKER workers[SEARCH_MAX_THREADS];
+static int workerCount;
+static int stateSize;
+static long stateLimit;
+static int approximate;
+
+// Level being expanded, index of its queues
+static int level;
+static int current;
+// Items queued but not yet expanded on this level
+static atomic_long pending;
+// Items queued for the next level
+static atomic_long queuedNext;
+// Stored states
+static atomic_long stateCount;
+// Set when a solution is found or the search fails
+static atomic_int done;
+static atomic_int failed;
+// Set when the state limit stops the search
+static atomic_int limited;
+// Set when the workers should quit
+static bool stop;
+
+// Level barrier, made by hand as pthread barriers are
+// not available everywhere
+static pthread_mutex_t barrierLock;
+static pthread_cond_t barrierCond;
+static int barrierCount;
+static int barrierArrived;
+static unsigned int barrierGen;
+
+// Best solution
+static pthread_mutex_t bestLock;
+static int bestNode;
+static int bestMove;
+static int bestTurns;
+
+
+// Wait for every worker, true for the last one to arrive
+static bool barrier_wait()
+{
+    bool last;
+
+    pthread_mutex_lock(&barrierLock);
+    unsigned int gen = barrierGen;
+    last = ++ barrierArrived >= barrierCount;
+    if(last)
+    {
+        barrierArrived = 0;
+        ++ barrierGen;
+        pthread_cond_broadcast(&barrierCond);
+    }
+    else
+    {
+        while(gen == barrierGen)
+            pthread_cond_wait(&barrierCond,&barrierLock);
+    }
+    pthread_mutex_unlock(&barrierLock);
+
+    return last;
+}
+
+
+// Push to the bottom of a deque
+static int deque_push(DEQUE* d, ITEM item)
+{
+    pthread_mutex_lock(&d->lock);
+    if(d->tail - d->head == d->size)
+    {
+        unsigned int size = d->size == 0 ? 1024 : d->size * 2;
+        ITEM* items = (ITEM*)malloc(sizeof(ITEM) * size);
+        if(items == NULL)
+        {
+            pthread_mutex_unlock(&d->lock);
+            return 1;
+        }
+
+        unsigned int i = 0;
+        for(; i < d->tail - d->head; ++ i)
+        {
+            items[i] = d->items[(d->head + i) & (d->size-1)];
+        }
+        free(d->items);
+        d->items = items;
+        d->tail -= d->head;
+        d->head = 0;
+        d->size = size;
+    }
+    d->items[(d->tail ++) & (d->size-1)] = item;
+    pthread_mutex_unlock(&d->lock);
+
+    return 0;
+}
+
+
+// Take from the bottom (owner) or the top (thief)
+static bool deque_take(DEQUE* d, ITEM* item, bool top)
+{
+    bool ret = false;
+
+    pthread_mutex_lock(&d->lock);
+    if(d->tail != d->head)
+    {
+        if(top)
+            *item = d->items[(d->head ++) & (d->size-1)];
+        else
+            *item = d->items[(-- d->tail) & (d->size-1)];
+        ret = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+
+    return ret;
+}
+
+
+// Find the table slot of a state in a shard, or the
+// empty slot it goes to. With a key the stored state is
+// compared as well, so two states sharing a hash stay
+// apart. Without one the hash is the identity
+static unsigned int find_slot(SHARD* sh, unsigned long long h, const unsigned char* key)
+{
+    unsigned int i = (unsigned int)(h >> SHARD_BITS) & (sh->tableSize-1);
+    int n;
+    while((n = sh->table[i]) >= 0)
+    {
+        if(sh->hashes[n] == h && (key == NULL
+            || memcmp(sh->keys + (size_t)n*stateSize,key,stateSize) == 0))
+            break;
+
+        i = (i+1) & (sh->tableSize-1);
+    }
+    return i;
+}
+
+
+// Make room for one more state in a shard
+static int shard_reserve(SHARD* sh)
+{
+    unsigned int i;
+
+    // Table
+    if((unsigned int)sh->count*2 >= sh->tableSize)
+    {
+        int* old = sh->table;
+        unsigned int oldSize = sh->tableSize;
+
+        unsigned int size = oldSize == 0 ? 1024 : oldSize * 2;
+        int* table = (int*)malloc(sizeof(int) * size);
+        if(table == NULL) return 1;
+        memset(table,0xFF,sizeof(int) * size);
+
+        sh->table = table;
+        sh->tableSize = size;
+        // Every node is distinct, so each goes to the first
+        // empty slot even if another shares its hash
+        for(i = 0; i < oldSize; ++ i)
+        {
+            if(old[i] < 0) continue;
+
+            unsigned int j = (unsigned int)(sh->hashes[old[i]] >> SHARD_BITS) & (size-1);
+            while(table[j] >= 0)
+            {
+                j = (j+1) & (size-1);
+            }
+            table[j] = old[i];
+        }
+        free(old);
+    }
+
+    // Nodes
+    if(sh->count < sh->capacity) return 0;
+    if(sh->capacity >= (1 << LOCAL_BITS)) return 1;
+
+    int cap = sh->capacity == 0 ? 512 : sh->capacity * 2;
+    unsigned char* k = (unsigned char*)realloc(sh->keys,(size_t)cap*stateSize);
+    if(k == NULL) return 1;
+    sh->keys = k;
+
+    unsigned long long* h = (unsigned long long*)realloc(sh->hashes,sizeof(unsigned long long) * cap);
+    if(h == NULL) return 1;
+    sh->hashes = h;
+
+    int* p = (int*)realloc(sh->parent,sizeof(int) * cap);
+    if(p == NULL) return 1;
+    sh->parent = p;
+
+    unsigned char* m = (unsigned char*)realloc(sh->move,cap);
+    if(m == NULL) return 1;
+    sh->move = m;
+
+    int* c = (int*)realloc(sh->cost,sizeof(int) * cap);
+    if(c == NULL) return 1;
+    sh->cost = c;
+
+    sh->capacity = cap;
+    return 0;
+}
+
+
+// Add a state or lower its cost. Returns the node, -1 if
+// the state is already known with the same or lower cost
+// and -2 on error
+static int visit(const unsigned char* s, unsigned long long h, int from, int m, int c)
+{
+    int id = (int)(h & (SHARD_COUNT-1));
+    SHARD* sh = &shards[id];
+    int n;
+
+    pthread_mutex_lock(&sh->lock);
+
+    if(shard_reserve(sh) != 0)
+    {
+        pthread_mutex_unlock(&sh->lock);
+        return -2;
+    }
+
+    // An exact search must not merge two states on a hash
+    // collision. The approximate keys only stand for a part
+    // of the state, so there the hash is all there is
+    unsigned int slot = find_slot(sh,h,approximate == SEARCH_EXACT ? s : NULL);
+    n = sh->table[slot];
+    if(n >= 0)
+    {
+        if(sh->cost[n] <= c)
+        {
+            pthread_mutex_unlock(&sh->lock);
+            return -1;
+        }
+    }
+    else
+    {
+        n = sh->count ++;
+        memcpy(sh->keys + (size_t)n*stateSize,s,stateSize);
+        sh->hashes[n] = h;
+        sh->table[slot] = n;
+        atomic_fetch_add(&stateCount,1);
+    }
+
+    sh->parent[n] = from;
+    sh->move[n] = (unsigned char)m;
+    sh->cost[n] = c;
+
+    pthread_mutex_unlock(&sh->lock);
+
+    return (id << LOCAL_BITS) | n;
+}
+
+
+// Get the hashes the visited-set is keyed by, returns
+// the count. An exact search has one, the full state.
+// Approximate searches leave the enemies out, and on the
+// second level add one key per enemy with only that enemy
+// put back. A state is kept if any of its keys is new, so
+// moves that only shift the enemies are kept while they
+// bring one somewhere new. The collision map is left out
+// as well, since the enemies overwrite the cells they
+// walk through, and otherwise it only changes with the
+// tiles
+static int state_keys(GAME_CONTEXT* ctx, unsigned long long* keys)
+{
+    unsigned long long h = sim_get_hash(ctx);
+    POINT dim = stage_get_map_size(ctx);
+    int count = 1;
+    int i = 0;
+    OBJECT* o;
+
+    if(approximate == SEARCH_EXACT)
+    {
+        keys[0] = h;
+        return 1;
+    }
+
+    for(; i < dim.x*dim.y; ++ i)
+    {
+        h ^= zobrist_key(ZOBRIST_COLLISION,i,ctx->stage.colMap[i]);
+    }
+    for(i = 0; i < obj_get_count(ctx); ++ i)
+    {
+        o = obj_get(ctx,i);
+        if(o->type != OBJ_ENEMY) continue;
+
+        h ^= zobrist_key(ZOBRIST_OBJECT,i,zobrist_object_value(o))
+            ^ zobrist_key(ZOBRIST_OBJECT,i,o->exist);
+    }
+    keys[0] = h;
+    if(approximate == SEARCH_NO_ENEMIES)
+        return 1;
+
+    for(i = 0; i < obj_get_count(ctx) && count < MAX_KEYS; ++ i)
+    {
+        o = obj_get(ctx,i);
+        if(o->type != OBJ_ENEMY || !o->exist) continue;
+
+        keys[count ++] = h ^ zobrist_key(ZOBRIST_OBJECT,i,zobrist_object_value(o))
+            ^ zobrist_key(ZOBRIST_OBJECT,i,o->exist);
+    }
+
+    return count;
+}
+
+
+// Copy the state of a node, false if the item is stale
+static bool get_state(ITEM item, unsigned char* out)
+{
+    SHARD* sh = &shards[item.node >> LOCAL_BITS];
+    int n = item.node & ((1 << LOCAL_BITS) -1);
+    bool ret;
+
+    pthread_mutex_lock(&sh->lock);
+    ret = sh->cost[n] == item.cost;
+    if(ret)
+        memcpy(out,sh->keys + (size_t)n*stateSize,stateSize);
+    pthread_mutex_unlock(&sh->lock);
+
+    return ret;
+}
+
+
+// Queue an item, zero-cost moves stay on this level
+static void enqueue(WORKER* w, ITEM item, bool sameLevel)
+{
+    if(sameLevel)
+        atomic_fetch_add(&pending,1);
+    else
+        atomic_fetch_add(&queuedNext,1);
+
+    if(deque_push(&w->queue[sameLevel ? current : 1-current],item) != 0)
+    {
+        atomic_store(&failed,1);
+        atomic_store(&done,1);
+    }
+}
+
+
+// Expand a node
+static void expand(WORKER* w, ITEM item)
+{
+    unsigned long long keys[MAX_KEYS];
+    unsigned long long h;
+    TT_ENTRY e;
+    int m = 0;
+    int ret, n, c, k, count, node;
+
+    if(!get_state(item,w->key)) return;
+    ++ w->expanded;
+
+    for(; m < MOVE_COUNT; ++ m)
+    {
+        state_unpack(&w->ctx,w->key);
+        ret = turn_apply(&w->ctx,m);
+
+        if(ret == TURN_WON)
+        {
+            // Winning takes a turn, so every win found on
+            // this level is optimal
+            c = item.cost + status_get_turn_count(&w->ctx);
+            pthread_mutex_lock(&bestLock);
+            if(bestTurns < 0 || c < bestTurns)
+            {
+                bestTurns = c;
+                bestNode = item.node;
+                bestMove = m;
+            }
+            pthread_mutex_unlock(&bestLock);
+            atomic_store(&done,1);
+            return;
+        }
+        if(ret != TURN_MOVED) continue;
+
+        c = item.cost + status_get_turn_count(&w->ctx);
+        count = state_keys(&w->ctx,keys);
+        node = -1;
+
+        for(k = 0; k < count; ++ k)
+        {
+            // Keys this worker has already seen with the same
+            // or lower cost are dropped without locking a shard
+            h = keys[k];
+            if(tt_probe(w->tt,h,&e) && e.value <= c)
+            {
+                ++ w->filtered;
+                continue;
+            }
+            tt_store(w->tt,h,c,level);
+
+            if(node < 0)
+                state_pack(&w->ctx,w->child);
+            n = visit(w->child,h,item.node,m,c);
+            if(n == -2)
+            {
+                atomic_store(&failed,1);
+                atomic_store(&done,1);
+                return;
+            }
+
+            // The other new keys only mark the state seen
+            if(n >= 0 && node < 0)
+                node = n;
+        }
+        if(node >= 0)
+            enqueue(w,(ITEM){node,c},c == item.cost);
+    }
+
+    if(atomic_load(&stateCount) >= stateLimit)
+    {
+        atomic_store(&limited,1);
+        atomic_store(&done,1);
+    }
+}
+
+
+// Take work, from the own queue first, then from the others
+static bool find_work(WORKER* w, ITEM* item)
+{
+    int i = 0;
+    int victim;
+
+    if(deque_take(&w->queue[current],item,false))
+        return true;
+
+    victim = (int)(rand_r(&w->seed) % workerCount);
+    for(; i < workerCount; ++ i, victim = (victim+1) % workerCount)
+    {
+        if(victim == w->index) continue;
+        if(deque_take(&workers[victim].queue[current],item,true))
+        {
+            ++ w->steals;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Prepare the next level, run by one worker between levels
+static void next_level()
+{
+    if(atomic_load(&done) || atomic_load(&queuedNext) == 0)
+    {
+        stop = true;
+        return;
+    }
+
+    current = 1-current;
+    ++ level;
+    atomic_store(&pending,atomic_load(&queuedNext));
+    atomic_store(&queuedNext,0);
+}
+
+
+// Worker thread
+static void* worker_run(void* data)
+{
+    WORKER* w = (WORKER*)data;
+    ITEM item;
+
+    for(;;)
+    {
+        barrier_wait();
+        if(stop) break;
+
+        while(!atomic_load(&done))
+        {
+            if(find_work(w,&item))
+            {
+                expand(w,item);
+                atomic_fetch_sub(&pending,1);
+            }
+            else if(atomic_load(&pending) == 0)
+            {
+                break;
+            }
+            else
+            {
+                sched_yield();
+            }
+        }
+
+        if(barrier_wait())
+            next_level();
+    }
+
+    return NULL;
+}
+
+
+// Wall clock time in seconds
+static double wall_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+
+// Free everything
+static void clear_search()
+{
+    int i = 0;
+    for(; i < SHARD_COUNT; ++ i)
+    {
+        SHARD* sh = &shards[i];
+        free(sh->keys);
+        free(sh->hashes);
+        free(sh->parent);
+        free(sh->move);
+        free(sh->cost);
+        free(sh->table);
+        pthread_mutex_destroy(&sh->lock);
+    }
+    for(i = 0; i < workerCount; ++ i)
+    {
+        WORKER* w = &workers[i];
+        free(w->queue[0].items);
+        free(w->queue[1].items);
+        pthread_mutex_destroy(&w->queue[0].lock);
+        pthread_mutex_destroy(&w->queue[1].lock);
+        free(w->key);
+        free(w->child);
+        tt_destroy(w->tt);
+        sim_destroy(&w->ctx);
+    }
+    pthread_mutex_destroy(&bestLock);
+    pthread_mutex_destroy(&barrierLock);
+    pthread_cond_destroy(&barrierCond);
+}
+
+
+// Get the memory in use
+static size_t memory_used()
+{
+    size_t mem = 0;
+    int i = 0;
+    for(; i < SHARD_COUNT; ++ i)
+    {
+        mem += (size_t)shards[i].capacity
+            * (stateSize + sizeof(unsigned long long) + sizeof(int)*2 + 1);
+        mem += (size_t)shards[i].tableSize * sizeof(int);
+    }
+    for(i = 0; i < workerCount; ++ i)
+    {
+        mem += (size_t)(workers[i].queue[0].size + workers[i].queue[1].size) * sizeof(ITEM);
+        if(workers[i].tt != NULL)
+            mem += tt_get_size(workers[i].tt);
+    }
+    return mem;
+}
+
+
+// Walk the path back from the winning node
+static void get_path(SEARCH_RESULT* res)
+{
+    int n;
+    int i;
+
+    res->length = 1;
+    for(n = bestNode; shards[n >> LOCAL_BITS].parent[n & ((1 << LOCAL_BITS) -1)] >= 0;
+        n = shards[n >> LOCAL_BITS].parent[n & ((1 << LOCAL_BITS) -1)])
+    {
+        ++ res->length;
+    }
+    if(res->length > SEARCH_MAX_PATH)
+    {
+        res->length = 0;
+        return;
+    }
+
+    res->path[res->length-1] = (unsigned char)bestMove;
+    i = res->length-2;
+    for(n = bestNode; i >= 0; -- i)
+    {
+        SHARD* sh = &shards[n >> LOCAL_BITS];
+        int local = n & ((1 << LOCAL_BITS) -1);
+        res->path[i] = sh->move[local];
+        n = sh->parent[local];
+    }
+}
+
+
+// Solve
+int search_solve(TILEMAP* map, int threads, long maxStates, int approx, SEARCH_RESULT* res)
+{
+    int i = 0;
+    int err = 0;
+
+    memset(res,0,sizeof(SEARCH_RESULT));
+    res->turns = -1;
+
+    if(threads < 1) threads = 1;
+    if(threads > SEARCH_MAX_THREADS) threads = SEARCH_MAX_THREADS;
+
+    memset(shards,0,sizeof(shards));
+    memset(workers,0,sizeof(WORKER) * threads);
+    for(; i < SHARD_COUNT; ++ i)
+    {
+        pthread_mutex_init(&shards[i].lock,NULL);
+    }
+    pthread_mutex_init(&bestLock,NULL);
+    pthread_mutex_init(&barrierLock,NULL);
+    pthread_cond_init(&barrierCond,NULL);
+    barrierCount = threads;
+    barrierArrived = 0;
+
+    workerCount = threads;
+    stateLimit = maxStates;
+    approximate = approx;
+    level = 0;
+    current = 0;
+    stop = false;
+    bestNode = -1;
+    bestMove = 0;
+    bestTurns = -1;
+    atomic_store(&pending,0);
+    atomic_store(&queuedNext,0);
+    atomic_store(&stateCount,0);
+    atomic_store(&done,0);
+    atomic_store(&failed,0);
+    atomic_store(&limited,0);
+
+    // Every worker simulates in a context of its own
+    for(i = 0; i < threads; ++ i)
+    {
+        WORKER* w = &workers[i];
+        w->index = i;
+        w->seed = (unsigned int)i + 1;
+        pthread_mutex_init(&w->queue[0].lock,NULL);
+        pthread_mutex_init(&w->queue[1].lock,NULL);
+
+        sim_init(&w->ctx);
+        if(sim_load(&w->ctx,map) != 0 || turn_settle(&w->ctx) != TURN_MOVED)
+            err = 1;
+
+        stateSize = state_get_size(&w->ctx);
+        w->key = (unsigned char*)malloc(stateSize);
+        w->child = (unsigned char*)malloc(stateSize);
+        w->tt = tt_create(WORKER_TT_SIZE);
+        if(w->key == NULL || w->child == NULL || w->tt == NULL)
+            err = 1;
+    }
+
+    // Start from the initial state
+    if(err == 0)
+    {
+        state_pack(&workers[0].ctx,workers[0].key);
+        unsigned long long keys[MAX_KEYS];
+        state_keys(&workers[0].ctx,keys);
+        int root = visit(workers[0].key,keys[0],-1,0,0);
+        if(root < 0 || deque_push(&workers[0].queue[0],(ITEM){root,0}) != 0)
+            err = 1;
+        atomic_store(&pending,1);
+    }
+
+    double start = wall_time();
+    if(err == 0)
+    {
+        for(i = 1; i < threads; ++ i)
+        {
+            if(pthread_create(&workers[i].thread,NULL,worker_run,&workers[i]) != 0)
+            {
+                // Go on with the threads created so far
+                pthread_mutex_lock(&barrierLock);
+                barrierCount = i;
+                workerCount = i;
+                pthread_mutex_unlock(&barrierLock);
+                break;
+            }
+        }
+        worker_run(&workers[0]);
+
+        for(i = 1; i < workerCount; ++ i)
+        {
+            pthread_join(workers[i].thread,NULL);
+        }
+    }
+    res->time = wall_time() - start;
+
+    // Results
+    if(err == 0 && !atomic_load(&failed))
+    {
+        if(bestNode >= 0)
+        {
+            res->turns = bestTurns;
+            get_path(res);
+        }
+    }
+    else
+    {
+        err = 1;
+    }
+
+    res->limited = atomic_load(&limited) != 0;
+    res->approximate = approximate;
+    res->states = atomic_load(&stateCount);
+    res->memory = memory_used();
+    for(i = 0; i < workerCount; ++ i)
+    {
+        res->expanded += workers[i].expanded;
+        res->steals += workers[i].steals;
+        res->filtered += workers[i].filtered;
+    }
+
+    clear_search();
+
+    return err;
+}
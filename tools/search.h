@@ -0,0 +1,56 @@
+/// Parallel state-space search (header)
+/// (c) 2018 Jani Nykänen
+
+#ifndef __SEARCH__
+#define __SEARCH__
+
+#include "../src/lib/tmxc.h"
+
+#include "stddef.h"
+#include "stdbool.h"
+
+/// Max solution length
+#define SEARCH_MAX_PATH 1024
+/// Max amount of worker threads
+#define SEARCH_MAX_THREADS 64
+
+/// Approximation levels
+enum
+{
+    SEARCH_EXACT = 0, /// Every state, turn-optimal
+    SEARCH_NO_ENEMIES = 1, /// States that only differ in the enemies are merged
+    SEARCH_ONE_ENEMY = 2, /// Kept if new with the enemies out or with one of them
+};
+
+/// Search result
+typedef struct
+{
+    int turns; /// Turns of the best solution, -1 if none
+    bool limited; /// Stopped by the state limit
+    int approximate; /// Approximation level
+    int length; /// Moves in the solution
+    unsigned char path[SEARCH_MAX_PATH]; /// Moves
+    long expanded; /// Expanded states
+    long states; /// Stored states
+    long steals; /// Work items stolen from other workers
+    long filtered; /// Duplicates caught by the transposition tables
+    size_t memory; /// Memory used in bytes
+    double time; /// Wall clock time in seconds
+}
+SEARCH_RESULT;
+
+/// Search the turn-optimal solution of a stage. The search
+/// goes level by level in turn order, the workers share a
+/// level through work stealing and store the states to a
+/// sharded visited-set
+/// < map Stage map, the spawns must be extracted
+/// < threads Worker count
+/// < maxStates Stored state limit
+/// < approx Approximation level. Approximate searches
+///   store far fewer states, but the solution may not be
+///   optimal or may be missed
+/// < res Result
+/// > 0 on success (even if not solved), 1 on error
+int search_solve(TILEMAP* map, int threads, long maxStates, int approx, SEARCH_RESULT* res);
+
+#endif // __SEARCH__
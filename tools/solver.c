@@ -0,0 +1,358 @@
+/// Stage solver (source)
+/// (c) 2018 Jani Nykänen
+
+#include "../src/sim/sim.h"
+#include "../src/sim/turn.h"
+#include "../src/sim/state.h"
+#include "../src/sim/replay.h"
+#include "../src/lib/parseword.h"
+
+#include "search.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+// Max amount of stages
+#define MAX_STAGES 64
+// Default state limit
+#define DEFAULT_MAX_STATES 2000000
+
+// Stage info
+typedef struct
+{
+    char name[32];
+    char assetName[32];
+    int turnTarget;
+}
+STAGE;
+
+// Replay a solution from the start
+static bool verify(GAME_CONTEXT* ctx, TILEMAP* map, SEARCH_RESULT* res)
+{
+    int ret = TURN_BLOCKED;
+    int i = 0;
+
+    if(sim_load(ctx,map) != 0 || turn_settle(ctx) != TURN_MOVED)
+        return false;
+
+    for(; i < res->length; ++ i)
+    {
+        ret = turn_apply(ctx,res->path[i]);
+        if(ret != TURN_MOVED && ret != TURN_WON)
+            return false;
+    }
+
+    return ret == TURN_WON && status_get_turn_count(ctx) == res->turns;
+}
+
+
+// Record a tick of input & run it
+static int push_tick(GAME_CONTEXT* ctx, REPLAY* r, const SIM_INPUT* in)
+{
+    int buttons[REPLAY_BUTTONS] = {0};
+    buttons[0] = in->jump;
+
+    REPLAY_FRAME f = replay_make_frame(in->stick,buttons);
+    if(replay_push(r,&f) != 0) return 1;
+
+    sim_tick(ctx,in,1.0f);
+    return replay_trace(r,r->frameCount,(unsigned int)sim_get_hash(ctx));
+}
+
+
+// Has the stage ended in victory or death
+static bool has_ended(GAME_CONTEXT* ctx)
+{
+    return status_is_victory(ctx) || obj_get_player(ctx)->dying;
+}
+
+
+// Record ticks with no input until settled
+static int push_settle(GAME_CONTEXT* ctx, REPLAY* r)
+{
+    const SIM_INPUT NEUTRAL = (SIM_INPUT){vec2(0,0),SIM_BUTTON_UP};
+
+    int i = 0;
+    for(; i < TURN_MAX_TICKS; ++ i)
+    {
+        if(push_tick(ctx,r,&NEUTRAL) != 0) return 1;
+        if(has_ended(ctx) || turn_is_settled(ctx)) return 0;
+    }
+
+    return 1;
+}
+
+
+// Record the input of a solution, starting like the game
+static int record_solution(GAME_CONTEXT* ctx, TILEMAP* map, SEARCH_RESULT* res, REPLAY* r)
+{
+    SIM_INPUT script[TURN_MAX_SCRIPT];
+    int len, i, j;
+
+    if(sim_load(ctx,map) != 0) return 1;
+    sim_reset(ctx);
+
+    if(push_settle(ctx,r) != 0) return 1;
+    for(i = 0; i < res->length && !has_ended(ctx); ++ i)
+    {
+        len = turn_get_script(ctx,res->path[i],script);
+        for(j = 0; j < len && !has_ended(ctx); ++ j)
+        {
+            if(push_tick(ctx,r,&script[j]) != 0) return 1;
+        }
+        if(!has_ended(ctx) && push_settle(ctx,r) != 0)
+            return 1;
+    }
+
+    replay_finish(r,status_is_victory(ctx),status_get_turn_count(ctx),sim_get_hash(ctx));
+    return r->victory && r->turns == res->turns ? 0 : 1;
+}
+
+
+// Write a solution as a replay
+static int write_replay(TILEMAP* map, int index, SEARCH_RESULT* res, const char* dir)
+{
+    GAME_CONTEXT ctx;
+    char path[256];
+
+    REPLAY* r = replay_create(index,0);
+    if(r == NULL) return 1;
+
+    sim_init(&ctx);
+    int err = record_solution(&ctx,map,res,r);
+    sim_destroy(&ctx);
+
+    if(err == 0)
+    {
+        snprintf(path,256,"%s/%02d.rpl",dir,index+1);
+        err = replay_save(r,path);
+    }
+    replay_destroy(r);
+
+    return err;
+}
+
+
+// Load the stage list
+static int load_stages(const char* path, STAGE* stages, int max)
+{
+    WORDDATA* wd = parse_file(path);
+    if(wd == NULL) return -1;
+
+    int count = 0;
+    int w = 0;
+    for(; count < max && w+3 < wd->wordCount; ++ count, w += 4)
+    {
+        snprintf(stages[count].name,32,"%s",get_word(wd,w));
+        snprintf(stages[count].assetName,32,"%s",get_word(wd,w+1));
+        stages[count].turnTarget = (int)strtol(get_word(wd,w+3),NULL,10);
+    }
+    destroy_word_data(wd);
+
+    return count;
+}
+
+
+// Print a solve result
+static bool print_result(STAGE* stage, int index, TILEMAP* map, int err, SEARCH_RESULT* res,
+    const char* replayDir)
+{
+    GAME_CONTEXT ctx;
+    bool verified = false;
+    int j = 0;
+
+    if(err == 0 && res->turns >= 0)
+    {
+        sim_init(&ctx);
+        verified = verify(&ctx,map,res);
+        sim_destroy(&ctx);
+    }
+
+    printf("%02d \"%s\": ",index+1,stage->name);
+    if(err != 0)
+        printf("out of memory");
+    else if(res->turns < 0 && res->limited)
+        printf("state limit hit");
+    else if(res->turns < 0 && res->approximate)
+        printf("none found");
+    else if(res->turns < 0)
+        printf("no solution");
+    else
+        printf("%d turns (target %d)%s%s",res->turns,stage->turnTarget,
+            res->approximate ? ", approximate" : "",verified ? "" : ", NOT VERIFIED");
+    printf(", %ld expanded, %ld states, %ld filtered, %.1f MB, %.2f s\n",res->expanded,
+        res->states,res->filtered,res->memory / (1024.0*1024.0),res->time);
+
+    if(res->turns >= 0)
+    {
+        printf("   ");
+        for(; j < res->length; ++ j)
+            printf(" %s",turn_move_name(res->path[j]));
+        printf("\n");
+    }
+
+    if(verified && replayDir != NULL && write_replay(map,index,res,replayDir) != 0)
+    {
+        printf("    Failed to write a replay\n");
+        return false;
+    }
+
+    // Every listed stage can be solved, so only running out
+    // of states or an approximate miss is not an error
+    return err == 0 && (verified || (res->turns < 0 && (res->limited || res->approximate)));
+}
+
+
+// Solve a stage. An approximate search first leaves the
+// enemies out, then, if nothing is found, tries again
+// with one enemy at a time
+static int solve(TILEMAP* map, int threads, long maxStates, bool approx, SEARCH_RESULT* res)
+{
+    if(!approx)
+        return search_solve(map,threads,maxStates,SEARCH_EXACT,res);
+
+    int err = search_solve(map,threads,maxStates,SEARCH_NO_ENEMIES,res);
+    if(err == 0 && res->turns < 0)
+        err = search_solve(map,threads,maxStates,SEARCH_ONE_ENEMY,res);
+
+    return err;
+}
+
+
+// Solve a stage with 1, 2, 4... threads
+static bool benchmark(STAGE* stage, int index, TILEMAP* map, int maxThreads, long maxStates)
+{
+    static SEARCH_RESULT res;
+
+    double base = 0.0;
+    int turns = -1;
+    int t = 1;
+    bool ok = true;
+
+    printf("%02d \"%s\":\n",index+1,stage->name);
+    for(; t <= maxThreads; t *= 2)
+    {
+        if(search_solve(map,t,maxStates,SEARCH_EXACT,&res) != 0)
+        {
+            printf("  %2d threads: out of memory\n",t);
+            return false;
+        }
+        if(t == 1)
+        {
+            base = res.time;
+            turns = res.turns;
+        }
+        else if(res.turns != turns)
+        {
+            ok = false;
+        }
+
+        printf("  %2d threads: %d turns, %.3f s, %.2fx, %.0f states/s, %ld steals\n",
+            t,res.turns,res.time,res.time > 0.0 ? base / res.time : 0.0,
+            res.time > 0.0 ? res.expanded / res.time : 0.0,res.steals);
+    }
+
+    if(!ok)
+        printf("  Turn counts differ!\n");
+    return ok;
+}
+
+
+// Main
+// Usage: solver [-m max states] [-j threads] [-a] [-b] [-w dir] [stage numbers...]
+// With -b, every stage is solved with 1, 2, 4... up to the
+// given amount of threads to measure the scaling. With -w,
+// the solutions are written to the directory as replays.
+// With -a, the enemies are left out of the visited-set,
+// which finds long solutions that do not fit in memory
+// otherwise, but not always the optimal ones
+int main(int argc, char** argv)
+{
+    static STAGE stages[MAX_STAGES];
+    static SEARCH_RESULT res;
+
+    char path[64];
+    const char* replayDir = NULL;
+    long maxStates = DEFAULT_MAX_STATES;
+    int threads = 1;
+    bool bench = false;
+    bool approx = false;
+    int first = 1;
+    int failed = 0;
+    int i, j;
+
+    for(; first < argc && argv[first][0] == '-'; ++ first)
+    {
+        if(strcmp(argv[first],"-b") == 0)
+        {
+            bench = true;
+        }
+        else if(strcmp(argv[first],"-a") == 0)
+        {
+            approx = true;
+        }
+        else if(strcmp(argv[first],"-m") == 0 && first+1 < argc)
+        {
+            maxStates = strtol(argv[++ first],NULL,10);
+            if(maxStates <= 0) maxStates = DEFAULT_MAX_STATES;
+        }
+        else if(strcmp(argv[first],"-w") == 0 && first+1 < argc)
+        {
+            replayDir = argv[++ first];
+        }
+        else if(strcmp(argv[first],"-j") == 0 && first+1 < argc)
+        {
+            threads = (int)strtol(argv[++ first],NULL,10);
+            if(threads < 1) threads = 1;
+            if(threads > SEARCH_MAX_THREADS) threads = SEARCH_MAX_THREADS;
+        }
+        else
+        {
+            printf("Usage: solver [-m max states] [-j threads] [-a] [-b] [-w dir] [stage numbers...]\n");
+            return 1;
+        }
+    }
+    if(bench && threads == 1)
+        threads = 32;
+
+    int count = load_stages("assets/stages.list",stages,MAX_STAGES);
+    if(count < 0)
+    {
+        printf("Failed to load the stage list\n");
+        return 1;
+    }
+
+    for(i = 0; i < count; ++ i)
+    {
+        // Only the given stages, if any
+        if(argc > first)
+        {
+            for(j = first; j < argc && (int)strtol(argv[j],NULL,10) != i+1; ++ j);
+            if(j == argc) continue;
+        }
+
+        // The spawns are extracted here, the workers only
+        // read the map
+        snprintf(path,64,"assets/maps/%s.tmx",stages[i].assetName);
+        TILEMAP* map = load_tilemap(path);
+        if(map == NULL || tmx_extract_spawns(map,0,stage_is_spawn_tile) != 0)
+        {
+            printf("Failed to load %s\n",path);
+            return 1;
+        }
+
+        bool ok;
+        if(bench)
+            ok = benchmark(&stages[i],i,map,threads,maxStates);
+        else
+            ok = print_result(&stages[i],i,map,solve(map,threads,maxStates,approx,&res),&res,
+                replayDir);
+        if(!ok)
+            ++ failed;
+
+        destroy_tilemap(map);
+    }
+
+    return failed > 0 ? 1 : 0;
+}
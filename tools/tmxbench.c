@@ -0,0 +1,123 @@
+/// TMX loader benchmark (source)
+/// (c) 2018 Jani Nykänen
+
+#include "../src/lib/tmxc.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "time.h"
+
+// Default iteration count
+#define DEFAULT_ITERATIONS 2000
+// Max amount of maps
+#define MAX_MAPS 64
+
+
+// Read a whole file to the memory
+static char* read_file(const char* path, int* size)
+{
+    FILE* f = fopen(path,"rb");
+    if(f == NULL) return NULL;
+
+    fseek(f,0,SEEK_END);
+    *size = (int)ftell(f);
+    fseek(f,0,SEEK_SET);
+
+    char* data = (char*)malloc(*size);
+    if(data != NULL && fread(data,1,*size,f) != (size_t)*size)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+
+    return data;
+}
+
+
+// Main
+// Usage: tmxbench [iterations] [map files...]
+int main(int argc, char** argv)
+{
+    char defPaths[25][32];
+    const char* paths[MAX_MAPS];
+    char* content[MAX_MAPS];
+    int sizes[MAX_MAPS];
+    int count = 0;
+    int iterations = argc > 1 ? (int)strtol(argv[1],NULL,10) : DEFAULT_ITERATIONS;
+    if(iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    int i = 0;
+    int j = 0;
+
+    // Use the bundled stages by default
+    if(argc <= 2)
+    {
+        for(i = 0; i < 25; ++ i)
+        {
+            snprintf(defPaths[i],32,"assets/maps/%02d.tmx",i+1);
+            paths[count ++] = defPaths[i];
+        }
+    }
+    else
+    {
+        for(i = 2; i < argc && count < MAX_MAPS; ++ i)
+            paths[count ++] = argv[i];
+    }
+
+    // Read the files once for the in-memory benchmark
+    for(i = 0; i < count; ++ i)
+    {
+        content[i] = read_file(paths[i],&sizes[i]);
+        if(content[i] == NULL)
+        {
+            printf("Failed to read %s\n",paths[i]);
+            return 1;
+        }
+    }
+
+    // Parse from memory
+    TILEMAP* t;
+    long tiles = 0;
+    clock_t start = clock();
+    for(j = 0; j < iterations; ++ j)
+    {
+        for(i = 0; i < count; ++ i)
+        {
+            t = parse_tilemap(content[i],sizes[i]);
+            if(t == NULL)
+            {
+                printf("Failed to parse %s\n",paths[i]);
+                return 1;
+            }
+            tiles += t->tcount * t->layerCount;
+            destroy_tilemap(t);
+        }
+    }
+    double parseTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    // Load from disk
+    start = clock();
+    for(j = 0; j < iterations; ++ j)
+    {
+        for(i = 0; i < count; ++ i)
+        {
+            t = load_tilemap(paths[i]);
+            if(t == NULL) return 1;
+            destroy_tilemap(t);
+        }
+    }
+    double loadTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    double maps = (double)iterations * count;
+    printf("%d maps x %d iterations (%ld tiles parsed)\n",count,iterations,tiles);
+    printf("parse (memory): %.0f maps/s, %.2f us/map\n",
+        maps / parseTime, parseTime / maps * 1e6);
+    printf("load (file):    %.0f maps/s, %.2f us/map\n",
+        maps / loadTime, loadTime / maps * 1e6);
+
+    for(i = 0; i < count; ++ i)
+        free(content[i]);
+
+    return 0;
+}